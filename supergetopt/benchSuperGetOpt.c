@@ -0,0 +1,572 @@
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+/*********************************************************************
+    This file is part of SuperGetOpt.
+
+    SuperGetOpt is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    SuperGetOpt is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with SuperGetOpt.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+/* Benchmarks for the superGetOpt parser. Each run prints ns per argv token; the sweeps also print
+    allocations per parse and the same parse done with getopt_long. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/resource.h>
+
+#include "supergetopt.h"
+
+#define BENCH_MAXOPTS 5000
+#define BENCH_TOKENS  4096
+
+static int ival[BENCH_MAXOPTS];
+static char *fmt[BENCH_MAXOPTS+1];
+static char names[BENCH_MAXOPTS][16];
+static char fmtbuf[BENCH_MAXOPTS][24];
+
+/* malloc, calloc and realloc calls, counted by linking with --wrap (BENCH_LDFLAGS in the Makefile).
+    Build with -DBENCH_NO_WRAP where the linker has no --wrap; allocations then print as "-". */
+static long numAllocs;
+
+#ifndef BENCH_NO_WRAP
+#ifdef __cplusplus
+extern "C" {
+#endif
+void *__real_malloc( size_t size );
+void *__real_calloc( size_t num, size_t size );
+void *__real_realloc( void *p, size_t size );
+
+void *__wrap_malloc( size_t size ) { numAllocs++; return( __real_malloc( size ) ); }
+void *__wrap_calloc( size_t num, size_t size ) { numAllocs++; return( __real_calloc( num, size ) ); }
+void *__wrap_realloc( void *p, size_t size ) { numAllocs++; return( __real_realloc( p, size ) ); }
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+static double nowNs( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+/* one flagless "-optK" triplet per option, so parsing is all name lookup; fmt[numOpts] = NULL ends the list early */
+#define OPT(k)   fmt[k], &ival[k], "bench option"
+#define OPT10(k) OPT(k), OPT(k+1), OPT(k+2), OPT(k+3), OPT(k+4), OPT(k+5), OPT(k+6), OPT(k+7), OPT(k+8), OPT(k+9)
+#define OPT100(k) OPT10(k), OPT10(k+10), OPT10(k+20), OPT10(k+30), OPT10(k+40), OPT10(k+50), OPT10(k+60), OPT10(k+70), OPT10(k+80), OPT10(k+90)
+#define OPT1000(k) OPT100(k), OPT100(k+100), OPT100(k+200), OPT100(k+300), OPT100(k+400), OPT100(k+500), OPT100(k+600), OPT100(k+700), OPT100(k+800), OPT100(k+900)
+
+static superOptSpec_t *compileBenchSpec( int numOpts )
+{
+    static int cut = -1;
+    superOptSpec_t *spec = NULL;
+    int k;
+
+    if( cut < 0 )
+    {
+        for( k = 0 ; k < BENCH_MAXOPTS ; k++ )
+        {
+            sprintf( names[k], "-opt%d", k );
+            sprintf( fmtbuf[k], "%s", names[k] );
+            fmt[k] = fmtbuf[k];
+        }
+    }
+    else fmt[cut] = fmtbuf[cut];
+    cut = numOpts;
+    fmt[numOpts] = NULL;
+
+    if( superCompileOpt( &spec, OPT1000(0), OPT1000(1000), OPT1000(2000), OPT1000(3000), OPT1000(4000), NULL ) < 0 )
+    {
+        fprintf(stderr, "bench: compile failed for %d options\n", numOpts);
+        exit(1);
+    }
+    return( spec );
+}
+
+/* option names spread over the whole spec */
+static void fillArgv( char **argv, int numTokens, int numOpts )
+{
+    int t;
+
+    for( t = 0 ; t < numTokens ; t++ )
+    {
+        argv[t] = names[(t * 7919) % numOpts];
+    }
+}
+
+/* the cost of name lookup alone as the spec grows */
+static void benchLookup( void )
+{
+    static char *argv[BENCH_TOKENS];
+    static const int sizes[] = { 5, 10, 25, 50, 75, 100 };
+    int s, r, n, pos, reps = 200;
+    double t0, hashNs, scanNs;
+    volatile int sink = 0;
+
+    printf("%-10s %14s %14s\n", "options", "parse ns/tok", "strcmp ns/tok");
+    for( s = 0 ; s < (int) (sizeof(sizes)/sizeof(sizes[0])) ; s++ )
+    {
+        superOptSpec_t *spec = compileBenchSpec( sizes[s] );
+
+        fillArgv( argv, BENCH_TOKENS, sizes[s] );
+
+        t0 = nowNs();
+        for( r = 0 ; r < reps ; r++ )
+        {
+            n = superParseSpec( spec, BENCH_TOKENS, argv, &pos );
+            if( n != 0 ) { fprintf(stderr, "bench: parse returned %d at %d\n", n, pos); exit(1); }
+        }
+        hashNs = (nowNs() - t0) / ((double) reps * BENCH_TOKENS);
+
+        /* what the old linear strcmp scan over the option list cost per token */
+        t0 = nowNs();
+        for( r = 0 ; r < reps ; r++ )
+        {
+            int t, k;
+            for( t = 0 ; t < BENCH_TOKENS ; t++ )
+            {
+                for( k = 0 ; k < sizes[s] ; k++ ) if( strcmp( argv[t], names[k] ) == 0 ) break;
+                sink += k;
+            }
+        }
+        scanNs = (nowNs() - t0) / ((double) reps * BENCH_TOKENS);
+
+        printf("%-10d %14.1f %14.1f\n", sizes[s], hashNs, scanNs);
+        superFreeOpt( spec );
+    }
+}
+
+/* long *%d and *%lf lists: the library converters against the sscanf calls they replaced */
+static void benchConvert( void )
+{
+    static char *argv[BENCH_TOKENS + 1];
+    static char values[BENCH_TOKENS][32];
+    static int iarray[BENCH_TOKENS];
+    static double darray[BENCH_TOKENS];
+    superOptSpec_t *spec = NULL;
+    int numi = BENCH_TOKENS, numd = BENCH_TOKENS;
+    int t, r, n, pos, pass, reps = 200;
+    double t0, parseNs, scanNs;
+    volatile double sink = 0;
+
+    if( superCompileOpt( &spec, "-i *%d", iarray, &numi, "ints", "-d *%lf", darray, &numd, "doubles", NULL ) < 0 ) exit(1);
+
+    printf("\n%-10s %14s %14s\n", "list", "parse ns/tok", "sscanf ns/tok");
+    for( pass = 0 ; pass < 2 ; pass++ )
+    {
+        argv[0] = (char *) (pass ? "-d" : "-i");
+        for( t = 1 ; t <= BENCH_TOKENS ; t++ )
+        {
+            if( pass ) sprintf( values[t-1], "%.15g", (t * 7919 % 100003) * 1.000123e-3 );
+            else sprintf( values[t-1], "%d", t * 7919 - 1000000 );
+            argv[t] = values[t-1];
+        }
+
+        t0 = nowNs();
+        for( r = 0 ; r < reps ; r++ )
+        {
+            n = superParseSpec( spec, BENCH_TOKENS + 1, argv, &pos );
+            if( n != 0 ) { fprintf(stderr, "bench: parse returned %d at %d\n", n, pos); exit(1); }
+        }
+        parseNs = (nowNs() - t0) / ((double) reps * BENCH_TOKENS);
+
+        t0 = nowNs();
+        for( r = 0 ; r < reps ; r++ )
+        {
+            for( t = 1 ; t <= BENCH_TOKENS ; t++ )
+            {
+                int x;
+                double d;
+                if( pass ) { sscanf( argv[t], "%lf", &d ); sink += d; }
+                else { sscanf( argv[t], "%d", &x ); sink += x; }
+            }
+        }
+        scanNs = (nowNs() - t0) / ((double) reps * BENCH_TOKENS);
+
+        printf("%-10s %14.1f %14.1f\n", pass ? "*%lf" : "*%d", parseNs, scanNs);
+    }
+
+    superFreeOpt( spec );
+}
+
+/* the sweeps below compile "--optK %d|%lf|%s" specs from a table, so the same options can be given to getopt_long */
+enum { MIX_INT, MIX_DOUBLE, MIX_STRING, MIX_ALL };
+
+static const int sweepTypes[] = { SG_TYPE_INT, SG_TYPE_DOUBLE, SG_TYPE_STRING };
+static char *sweepValues[] = { (char *) "12345", (char *) "3.25e2", (char *) "word" };
+static char longNames[BENCH_MAXOPTS][16];
+static double dval[BENCH_MAXOPTS];
+static char *sval[BENCH_MAXOPTS];
+static void *sweepPtrs[BENCH_MAXOPTS];
+static superOptDesc_t sweepTable[BENCH_MAXOPTS];
+static struct option longOpts[BENCH_MAXOPTS+1];
+static int sweepMix;
+
+static int sweepType( int k )
+{
+    return( sweepMix == MIX_ALL ? k % 3 : sweepMix );
+}
+
+static superOptSpec_t *compileSweepSpec( int numOpts, int mix )
+{
+    superOptSpec_t *spec = NULL;
+    int k;
+
+    sweepMix = mix;
+    for( k = 0 ; k < numOpts ; k++ )
+    {
+        int t = sweepType( k );
+
+        sprintf( longNames[k], "--opt%d", k );
+        sweepPtrs[k] = t == 0 ? (void *) &ival[k] : t == 1 ? (void *) &dval[k] : (void *) &sval[k];
+        sweepTable[k].name = longNames[k];
+        sweepTable[k].varflag = 0;
+        sweepTable[k].numArgs = 1;
+        sweepTable[k].types = &sweepTypes[t];
+        sweepTable[k].ptrs = &sweepPtrs[k];
+        sweepTable[k].pNumArgs = NULL;
+        sweepTable[k].bind = SG_BIND_ARRAY;
+        sweepTable[k].helpString = "sweep option";
+
+        longOpts[k].name = longNames[k] + 2;
+        longOpts[k].has_arg = required_argument;
+        longOpts[k].flag = NULL;
+        longOpts[k].val = 1000 + k;
+    }
+    memset( &longOpts[numOpts], 0, sizeof(longOpts[0]) );
+
+    if( superCompileTable( &spec, sweepTable, numOpts ) < 0 )
+    {
+        fprintf(stderr, "bench: table compile failed for %d options\n", numOpts);
+        exit(1);
+    }
+    return( spec );
+}
+
+/* argv[0] is a program name for getopt_long; then numPairs "--optK value" pairs with an extra
+    word before every extraEvery'th pair (0: none), and numTail extra words at the end */
+static int fillSweepArgv( char **argv, int numPairs, int numOpts, int extraEvery, int numTail )
+{
+    static char *extra = (char *) "extra";
+    int p, argc = 0;
+
+    argv[argc++] = (char *) "bench";
+    for( p = 0 ; p < numPairs ; p++ )
+    {
+        int k = (int) (((long) p * 7919) % numOpts);
+
+        if( extraEvery > 0 && p % extraEvery == 0 ) argv[argc++] = extra;
+        argv[argc++] = longNames[k];
+        argv[argc++] = sweepValues[sweepType( k )];
+    }
+    for( p = 0 ; p < numTail ; p++ ) argv[argc++] = extra;
+    return( argc );
+}
+
+static int repsFor( int numTokens )
+{
+    int reps = 1000000 / numTokens;
+    return( reps > 0 ? reps : 1 );
+}
+
+/* ns per token and allocations per parse. Extra args get moved to the end of argv, so every
+    parse works on a fresh copy; the copy is a memcpy of argc pointers and is timed too */
+static void timeSuper( superOptSpec_t *spec, char **argv, int argc, int expect, double *ns, double *allocs )
+{
+    char **work = (char **) malloc( argc * sizeof(char *) );
+    int r, n, pos, reps = repsFor( argc - 1 );
+    long allocs0;
+    double t0;
+
+    if( work == NULL ) exit(1);
+
+    /* the first parse sets up the thread's context */
+    memcpy( work, argv, argc * sizeof(char *) );
+    superParseSpec( spec, argc - 1, work + 1, &pos );
+
+    allocs0 = numAllocs;
+    t0 = nowNs();
+    for( r = 0 ; r < reps ; r++ )
+    {
+        memcpy( work, argv, argc * sizeof(char *) );
+        n = superParseSpec( spec, argc - 1, work + 1, &pos );
+        if( n != expect ) { fprintf(stderr, "bench: parse returned %d (expected %d) at %d\n", n, expect, pos); exit(1); }
+    }
+    *ns = (nowNs() - t0) / ((double) reps * (argc - 1));
+    *allocs = (numAllocs - allocs0) / (double) reps;
+    free( work );
+}
+
+/* the same options through getopt_long, converting each value with strtol/strtod */
+static double timeGetoptLong( char **argv, int argc, int numOpts, int expect )
+{
+    char **work = (char **) malloc( argc * sizeof(char *) );
+    int r, c, reps = repsFor( argc - 1 );
+    double t0;
+
+    if( work == NULL ) exit(1);
+
+    opterr = 0;
+    t0 = nowNs();
+    for( r = 0 ; r < reps ; r++ )
+    {
+        memcpy( work, argv, argc * sizeof(char *) );
+        optind = 0;
+        while( (c = getopt_long( argc, work, "", longOpts, NULL )) != -1 )
+        {
+            int k = c - 1000;
+            char *end = NULL;
+
+            if( k < 0 || k >= numOpts ) { fprintf(stderr, "bench: getopt_long returned %d\n", c); exit(1); }
+            switch( sweepType( k ) )
+            {
+                case 0: ival[k] = (int) strtol( optarg, &end, 10 ); break;
+                case 1: dval[k] = strtod( optarg, &end ); break;
+                default: sval[k] = optarg; end = (char *) ""; break;
+            }
+            if( *end != '\0' ) { fprintf(stderr, "bench: bad value <%s>\n", optarg); exit(1); }
+        }
+        if( argc - optind != expect ) { fprintf(stderr, "bench: getopt_long left %d extra args\n", argc - optind); exit(1); }
+    }
+    free( work );
+    return( (nowNs() - t0) / ((double) reps * (argc - 1)) );
+}
+
+static void printAllocs( double allocs )
+{
+#ifdef BENCH_NO_WRAP
+    (void) allocs;
+    printf(" %14s", "-");
+#else
+    printf(" %14.2f", allocs);
+#endif
+}
+
+static void sweepRow( const char *label, int numOpts, int mix, int numPairs, int extraEvery, int numTail )
+{
+    superOptSpec_t *spec = compileSweepSpec( numOpts, mix );
+    char **argv = (char **) malloc( (1 + 3 * numPairs + numTail) * sizeof(char *) );
+    int argc, expect;
+    double ns, allocs;
+
+    if( argv == NULL ) exit(1);
+    argc = fillSweepArgv( argv, numPairs, numOpts, extraEvery, numTail );
+    expect = (extraEvery > 0 ? (numPairs + extraEvery - 1) / extraEvery : 0) + numTail;
+
+    timeSuper( spec, argv, argc, expect, &ns, &allocs );
+    printf("%-14s %14.1f", label, ns);
+    printAllocs( allocs );
+    printf(" %14.1f\n", timeGetoptLong( argv, argc, numOpts, expect ));
+
+    superFreeOpt( spec );
+    free( argv );
+}
+
+static void sweepHeader( const char *what )
+{
+    printf("\n%-14s %14s %14s %14s\n", what, "parse ns/tok", "allocs/parse", "getopt_long");
+}
+
+/* option count, argc, type mix and extra arg patterns, each against getopt_long */
+static void benchSweep( void )
+{
+    static const int optCounts[] = { 10, 100, 1000 };
+    static const int pairCounts[] = { 5, 50, 500, 5000, 50000 };
+    static const char *mixNames[] = { "%d", "%lf", "%s", "mixed" };
+    char label[32];
+    int i;
+
+    sweepHeader( "options" );
+    for( i = 0 ; i < (int) (sizeof(optCounts)/sizeof(optCounts[0])) ; i++ )
+    {
+        sprintf( label, "%d", optCounts[i] );
+        sweepRow( label, optCounts[i], MIX_ALL, 1000, 0, 0 );
+    }
+
+    sweepHeader( "tokens" );
+    for( i = 0 ; i < (int) (sizeof(pairCounts)/sizeof(pairCounts[0])) ; i++ )
+    {
+        sprintf( label, "%d", 2 * pairCounts[i] );
+        sweepRow( label, 100, MIX_ALL, pairCounts[i], 0, 0 );
+    }
+
+    sweepHeader( "types" );
+    for( i = MIX_INT ; i <= MIX_ALL ; i++ ) sweepRow( mixNames[i], 100, i, 1000, 0, 0 );
+
+    sweepHeader( "extra args" );
+    sweepRow( "none", 100, MIX_ALL, 1000, 0, 0 );
+    sweepRow( "100 at end", 100, MIX_ALL, 1000, 0, 100 );
+    sweepRow( "1 in 10", 100, MIX_ALL, 1000, 10, 0 );
+    sweepRow( "every pair", 100, MIX_ALL, 1000, 1, 0 );
+}
+
+/* var lists of each type: the same number of values, given as lists of 1 to 4096 */
+static void benchVarLength( void )
+{
+    static const int lengths[] = { 1, 16, 256, 4096 };
+    static const char *listNames[] = { "-i", "-d", "-s" };
+    static int iarray[BENCH_TOKENS];
+    static double darray[BENCH_TOKENS];
+    static char *sarray[BENCH_TOKENS];
+    char **argv = (char **) malloc( (1 + 2 * BENCH_TOKENS) * sizeof(char *) );
+    superOptSpec_t *spec = NULL;
+    int numi = BENCH_TOKENS, numd = BENCH_TOKENS, nums = BENCH_TOKENS;
+    int l, type, argc, t;
+    double ns[3], allocs[3];
+
+    if( argv == NULL ) exit(1);
+    if( superCompileOpt( &spec, "-i *%d", iarray, &numi, "ints", "-d *%lf", darray, &numd, "doubles",
+                                "-s *%s", sarray, &nums, "strings", NULL ) < 0 ) exit(1);
+
+    printf("\n%-14s %14s %14s %14s %14s\n", "list length", "*%d ns/tok", "*%lf ns/tok", "*%s ns/tok", "allocs/parse");
+    for( l = 0 ; l < (int) (sizeof(lengths)/sizeof(lengths[0])) ; l++ )
+    {
+        for( type = 0 ; type < 3 ; type++ )
+        {
+            argc = 0;
+            argv[argc++] = (char *) "bench";
+            for( t = 0 ; t < BENCH_TOKENS ; t++ )
+            {
+                if( t % lengths[l] == 0 ) argv[argc++] = (char *) listNames[type];
+                argv[argc++] = sweepValues[type];
+            }
+            timeSuper( spec, argv, argc, 0, &ns[type], &allocs[type] );
+        }
+        printf("%-14d %14.1f %14.1f %14.1f", lengths[l], ns[0], ns[1], ns[2]);
+        printAllocs( allocs[0] + allocs[1] + allocs[2] );
+        printf("\n");
+    }
+
+    superFreeOpt( spec );
+    free( argv );
+}
+
+static long maxRssKb( void )
+{
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+    return( ru.ru_maxrss );
+}
+
+/* no caps: compile time per option as the spec grows to 5000 options, then parse time per token
+    and peak memory as argv grows to 1M tokens (options, a *%d list, and an extra word every 1000) */
+static void benchScale( void )
+{
+    static const int specSizes[] = { 100, 1000, 5000 };
+    static const int argvSizes[] = { 1000, 10000, 100000, 1000000 };
+    static char *extra = (char *) "extra";
+    superOptSpec_t *spec;
+    char **argv;
+    int *iarray;
+    int numi;
+    int s, t, n, pos, reps;
+    double t0, compileNs, parseNs;
+
+    printf("\n%-10s %14s %14s\n", "options", "compile ns/opt", "parse ns/tok");
+    for( s = 0 ; s < (int) (sizeof(specSizes)/sizeof(specSizes[0])) ; s++ )
+    {
+        static char *argvOpts[BENCH_TOKENS];
+
+        reps = 50;
+        t0 = nowNs();
+        for( n = 0 ; n < reps ; n++ ) superFreeOpt( compileBenchSpec( specSizes[s] ) );
+        compileNs = (nowNs() - t0) / ((double) reps * specSizes[s]);
+
+        spec = compileBenchSpec( specSizes[s] );
+        fillArgv( argvOpts, BENCH_TOKENS, specSizes[s] );
+        t0 = nowNs();
+        for( n = 0 ; n < reps ; n++ )
+        {
+            if( superParseSpec( spec, BENCH_TOKENS, argvOpts, &pos ) != 0 ) { fprintf(stderr, "bench: parse failed at %d\n", pos); exit(1); }
+        }
+        parseNs = (nowNs() - t0) / ((double) reps * BENCH_TOKENS);
+        superFreeOpt( spec );
+
+        printf("%-10d %14.1f %14.1f\n", specSizes[s], compileNs, parseNs);
+    }
+
+    printf("\n%-10s %14s %14s\n", "tokens", "parse ns/tok", "max rss KB");
+    for( s = 0 ; s < (int) (sizeof(argvSizes)/sizeof(argvSizes[0])) ; s++ )
+    {
+        int numTokens = argvSizes[s];
+
+        argv = (char **) malloc( numTokens * sizeof(char *) );
+        iarray = (int *) malloc( numTokens * sizeof(int) );
+        if( argv == NULL || iarray == NULL ) exit(1);
+
+        numi = numTokens;
+        if( superCompileOpt( &spec, OPT100(0), "-i *%d", iarray, &numi, "ints", NULL ) < 0 ) exit(1);
+
+        /* the first half names options, the second half is one long *%d list */
+        for( t = 0 ; t < numTokens / 2 ; t++ ) argv[t] = (t % 1000 == 999) ? extra : names[t % 100];
+        argv[t++] = (char *) "-i";
+        for( ; t < numTokens ; t++ ) argv[t] = (char *) "12345";
+
+        reps = 10000000 / numTokens;
+        t0 = nowNs();
+        for( n = 0 ; n < reps ; n++ )
+        {
+            int k = superParseSpec( spec, numTokens, argv, &pos );
+            if( k != numTokens / 2000 ) { fprintf(stderr, "bench: parse returned %d\n", k); exit(1); }
+        }
+        parseNs = (nowNs() - t0) / ((double) reps * numTokens);
+
+        printf("%-10d %14.1f %14ld\n", numTokens, parseNs, maxRssKb());
+        superFreeOpt( spec );
+        free( argv );
+        free( iarray );
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    (void) argc;
+    (void) argv;
+
+    benchLookup();
+    benchConvert();
+    benchSweep();
+    benchVarLength();
+    benchScale();
+
+    return(0);
+}
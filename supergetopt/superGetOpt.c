@@ -43,28 +43,45 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
 #include "supergetopt.h"
+#include "superGetOptConvert.h"
+#include "superGetOptInt.h"
 
-#define MAXARGS    10    /* no called function can have more than this number of args */
-#define MAXOPTS   100    /* only this many options total to superGetOpt() */
-#define MAXSTRING 120    /* max of any string passed through */
-#define MAX_ARG_GRPS 32  /* max groups of unaccounted for args */
+/* nothing is capped: options, args per option, names and unaccounted for groups all grow */
+#define FIRST_OPTS 16    /* option slots allocated for a spec's first options */
+#define FIRST_GRPS 16    /* unaccounted for groups allocated for a context's first parse */
+#define FIRST_GROW 16    /* values in a new SG_BIND_GROW array, and arrays a context first tracks */
+#define SG_AMBIGUOUS -2   /* prefixOption: the start of more than one name */
+#define USAGE_WIDTH 80    /* usage text width when the terminal's isn't known */
+#define USAGE_MIN_HELP 20 /* narrowest help column */
 
 enum 
 {
-    CHAR,
-    SHORT,
-    INT,
-    UINT,
-    HEX,
-    LINT,
-    FLOAT,
-    DOUBLE,
-    STRING,
-    NUMTYPES
+    CHAR = SG_TYPE_CHAR,
+    SHORT = SG_TYPE_SHORT,
+    INT = SG_TYPE_INT,
+    UINT = SG_TYPE_UINT,
+    HEX = SG_TYPE_HEX,
+    LINT = SG_TYPE_LONG,
+    FLOAT = SG_TYPE_FLOAT,
+    DOUBLE = SG_TYPE_DOUBLE,
+    STRING = SG_TYPE_STRING,
+    SIZE = SG_TYPE_SIZE,
+    DURATION = SG_TYPE_DURATION,
+    NUMTYPES = SG_NUM_TYPES
 };
 
-const char typeNames[NUMTYPES][10] = { "char", "short", "int", "uint", "hex", "lint", "float", "double", "string" };
+const char typeNames[NUMTYPES][10] = { "char", "short", "int", "uint", "hex", "lint", "float", "double", "string",
+    "size", "duration" };
+static const char *const expectedNames[NUMTYPES] = { "character", "short", "integer", "unsigned integer", "hex integer",
+    "long integer", "float", "double", "string", "size like 64Ki or 4G", "duration like 250ms or 1h30m" };
 
 typedef union
 {
@@ -76,6 +93,8 @@ typedef union
     float f;
     double d;
     char *string;
+    unsigned long long ull;     // sizes
+    long long ll;               // durations, in nanoseconds
 } ANYTYPE;
 
 typedef union
@@ -88,40 +107,137 @@ typedef union
     float *f;
     double *d;
     char **string;
+    unsigned long long *ull;
+    long long *ll;
 #ifdef __cplusplus
     std::vector<char> *v;
     std::vector<char> *vc;
     std::vector<short> *vh;
     std::vector<int> *vi;
     std::vector<unsigned int> *vui;
-    std::vector<int> *vli;
+    std::vector<long> *vli;
     std::vector<float> *vf;
     std::vector<double> *vd;
     std::vector<const char *> *vcp;
+    std::vector<unsigned long long> *vull;
+    std::vector<long long> *vll;
+#if __cplusplus >= 201703L
+    std::vector<std::string_view> *vsv;
+#endif
 #endif
 } PANYTYPE;
 
 struct optionlist_s 
 {
-    char name[MAXSTRING];
+    char *name;
     int numargs;
     int varflag;
-    int argtype[MAXARGS];
-    PANYTYPE argptr[MAXARGS];
-    ANYTYPE argval[MAXARGS];
+    int *argtype;               /* numargs entries (at least one), in the spec's arena */
+    PANYTYPE *argptr;
     int *pNumArgs;
     int numArgsMax;
+    int bind;                   /* var lists: SG_BIND_*. SG_BIND_SINK for any option with a sink */
+    superSink_t sink;
+    void *sinkUser;
     char *helpString;
 };
 
-typedef struct unaccArgsList_s
+/* a compiled option spec: formats parsed and pointers bound once, reusable across parses */
+struct superOptSpec_s
+{
+    int optnum;
+    int optCap;
+    struct optionlist_s *optionlist;    /* grows by doubling */
+    int maxArgs;                /* most args of any option */
+    sgArena_t arena;            /* names, arg types and pointers, the name index */
+    unsigned int hashMask;      /* name index: option number per slot, -1 when empty */
+    int hashMaxProbe;
+    int *hashSlot;
+    unsigned int *hashVal;
+    unsigned char nameStart[32];    /* bit per first character of any name: most values skip the hash */
+    int shortOpt[256];          /* option number + 1 of each one character name "-c", 0 if none */
+    int *byName;                /* option numbers in name order, for prefixes and completion */
+    int numNames;
+    struct usageText_s *usage;  /* rendered usage, one per width asked for, until recompiled */
+    const char *badFormat;      /* the format a failed compile stopped at */
+};
+
+struct usageText_s
+{
+    struct usageText_s *next;
+    int width;
+    size_t len;
+    char text[1];
+};
+
+/* an SG_BIND_GROW array: this header, then the values. The caller's pointer is to the values */
+typedef union
+{
+    struct
+    {
+        size_t cap;             /* values that fit */
+        int slot;               /* where the owner lists it */
+        const superOptCtx_t *owner;
+    } h;
+    long double align;          /* the values after it are aligned for any type */
+} growHeader_t;
+
+typedef struct
+{
+    char **where;               /* the caller's pointer to the values */
+    growHeader_t *block;
+} grownArray_t;
+
+/* all per-parse state. One per thread, or one per concurrent parse */
+struct superOptCtx_s
 {
-    int start;
-    int stop;
-} unaccArgsList_t;
+    superOptSpec_t *spec;       /* compiled by the varargs entry points, kept for usage */
+    int ownsSelf;               /* came from superCtxNew */
+    int unAccountedFor;
+    int numUnaccGroups;
+    int unaccGroupsCap;
+    superArgSpan_t *unaccountedForIndex;
+    int extrasMode;             /* SG_EXTRAS_*: group extra args in argv or just list them */
+    int nameMode;               /* SG_NAMES_*: exact option names, or unique prefixes too */
+    int diagMode;               /* SG_DIAG_*: print diagnostics, or only keep them */
+    int stringMode;             /* SG_STRINGS_*: string values point into argv, or are copied to strings */
+    superDiag_t diag;           /* what ended the last parse */
+    char **extraArgs;           /* grouping scratch: extra args on their way to the end */
+    int extraArgsCap;
+    PANYTYPE *argptr;           /* the current option's relocated pointers */
+    int argptrCap;
+    const char *bindBase;       /* batch parses: spec pointers in [bindBase, bindBase+bindSize) */
+    size_t bindSize;            /* land at the same offset from outBase */
+    char *outBase;
+    sgRsp_t rsp;                /* @file expansion: mapped files and the argv built from them */
+    sgEnv_t env;                /* environment fallback for options argv didn't give */
+    int argc;                   /* the argv the last superCtxGetOpt/ParseOpt call parsed */
+    char **argv;
+    int lineMode;               /* parsing a config file line by line: */
+    int keepVarCounts;          /*   var counts carry over from earlier lines */
+    sgArena_t strings;          /* string values are copied here, off a reused line buffer or as asked */
+    grownArray_t *grown;        /* the SG_BIND_GROW arrays this context grew, until superCtxFreeLists */
+    int numGrown;
+    int grownCap;
+};
 
-static int superParseInternal( int argc, char **argv, int usageCall,  int *lastArg, int *pUnAccountedFor, int *pNumUnaccGroups, unaccArgsList_t *unaccountedForIndex, va_list ap );
-static ANYTYPE getval(char *s, int type, int *flag);
+static int superParseInternal( superOptCtx_t *ctx, int argc, char **argv, int usageCall,  int *lastArg, va_list ap );
+static superOptCtx_t *getThreadCtx( void );
+static int compileSpec( superOptSpec_t *spec, va_list ap );
+static int compileTable( superOptSpec_t *spec, const superOptDesc_t *table, int numOpts );
+static struct optionlist_s *newOption( superOptSpec_t *spec );
+static int parseSpec( superOptCtx_t *ctx, const superOptSpec_t *spec, int argc, char **argv, int usageCall, int *lastArg );
+static int sinkValues( superOptCtx_t *ctx, const superOptSpec_t *spec, const struct optionlist_s *opt, char **argv, int argsleft, int pos, char *attached, int *lastArg );
+static int tupleValues( superOptCtx_t *ctx, const superOptSpec_t *spec, const struct optionlist_s *opt, char **argv, int argsleft, int pos, char *attached, int *lastArg );
+static void *relocate( const superOptCtx_t *ctx, void *p );
+static int counted( const struct optionlist_s *o );
+static int growColumn( superOptCtx_t *ctx, char **where, size_t size, int n );
+static void freeLists( superOptCtx_t *ctx, int clear );
+static char *keepString( superOptCtx_t *ctx, char *s );
+static void startStrings( superOptCtx_t *ctx, int argc, char **argv );
+static void printUsage( const superOptSpec_t *spec );
+static void freeUsage( superOptSpec_t *spec );
+static ANYTYPE convertValue(char *s, int type, int *flag);
 static char myread_char(char *s, int *flag);
 static short myread_short(char *s, int *flag);
 static int myread_int(char *s, int *flag);
@@ -130,297 +246,1651 @@ static unsigned int myread_hex(char *s, int *flag);
 static long myread_lint(char *s, int *flag);
 static float myread_float(char *s, int *flag);
 static double myread_double(char *s, int *flag);
-static int parse_string(char *s, struct optionlist_s *option, int *noName);
-static int check_if_option(char *s, struct optionlist_s *optionlist, int numopts);
-static int parse_format(char *s, int *argtypes);
-#if SG_GROUP_UNACC_ARGS
-static int groupUnaccArgs( int argc, char *argv[], int *pLastArg, int unAccountedFor, int numUnaccGroups, unaccArgsList_t *unaccountedForIndex, int argOffset );
+static unsigned long long myread_size(char *s, int *flag);
+static long long myread_duration(char *s, int *flag);
+static int parse_string(char *s, struct optionlist_s *option, int *noName, sgArena_t *arena);
+static int check_if_option(const superOptCtx_t *ctx, char *s, const superOptSpec_t *spec);
+#ifdef __cplusplus
+static int countValues( const superOptCtx_t *ctx, const superOptSpec_t *spec, char **argv, int argsleft );
+static void reserveVector( PANYTYPE *p, int type, int bind, int n );
+static void editColumn( PANYTYPE p, int type, const ANYTYPE *value );
 #endif
+static unsigned int hashName( const char *s );
+static int buildNameIndex( superOptSpec_t *spec );
+static int buildNameOrder( superOptSpec_t *spec );
+static int lookupOption( const superOptSpec_t *spec, const char *s );
+static int lookupOptionN( const superOptSpec_t *spec, const char *s, size_t len );
+static int prefixOption( const superOptSpec_t *spec, const char *s, size_t len );
+static int findOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, const char *s );
+static int attachedOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, char *s, char **pValue, char **pBundle );
+static int shortOption( const superOptSpec_t *spec, char *s, char **pValue, char **pBundle );
+static int parse_format(char *s, int *argtypes);
+static int placeExtras( superOptCtx_t *ctx, char **argv, int *lastArg );
+static void dropValue( superOptCtx_t *ctx, const char *option );
+static int applyEnv( superOptCtx_t *ctx, const superOptSpec_t *spec, int n, int *lastArg );
 
 int superGetOpt( int argc, char **argv, int *lastArg, ... )
 {
     va_list ap;
     int n;
+
+    va_start( ap, lastArg );
+
+    n = superCtxVGetOpt( getThreadCtx(), argc, argv, lastArg, ap );
+
+    va_end( ap );
+
+    return(n);
+}
+
+int superParseOpt( int argc, char **argv, int *lastArg, ... )
+{
+    va_list ap;
+    int n;
+
+    va_start( ap, lastArg );
+
+    n = superCtxVParseOpt( getThreadCtx(), argc, argv, lastArg, ap );
+
+    va_end( ap );
+
+    return(n);
+}
+
+int superCtxGetOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, ... )
+{
+    va_list ap;
+    int n;
+
+    va_start( ap, lastArg );
+
+    n = superCtxVGetOpt( ctx, argc, argv, lastArg, ap );
+
+    va_end( ap );
+
+    return(n);
+}
+
+int superCtxParseOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, ... )
+{
+    va_list ap;
+    int n;
+
+    va_start( ap, lastArg );
+
+    n = superCtxVParseOpt( ctx, argc, argv, lastArg, ap );
+
+    va_end( ap );
+
+    return(n);
+}
+
+int superCtxVGetOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, va_list ap )
+{
+    int n;
     int usageCall = 0;
-    int unAccountedFor;
-    unaccArgsList_t unaccountedForIndex[MAX_ARG_GRPS];
-    int numUnaccGroups = 0;
     
+    if( ctx == NULL ) return( SG_ERROR_MISSING_ARG );
+    sgCtxClearDiag( ctx );
+
+#if SG_ENABLE_RESPONSE_FILES
+    if( argv != NULL )
+    {
+        int badArg;
+
+        n = sgRspExpand( &ctx->rsp, argc, argv, 1, &argc, &argv, &badArg );
+        if( n < 0 )
+        {
+            if( lastArg ) *lastArg = badArg;
+            sgCtxSetDiag( ctx, n, badArg, NULL, -1, argv[badArg] );
+            sgCtxReportDiag( ctx );
+            return(n);
+        }
+    }
+#endif
+    startStrings( ctx, argc, argv );
+    ctx->argc = argc;
+    ctx->argv = argv;
+
     if( argv != NULL )    argv++;
     else usageCall = 1;
     
     if( argc <= 1 ) usageCall = 1;
     else    argc--;
 
-    va_start( ap, lastArg );
+    n = superParseInternal( ctx, argc, argv, usageCall, lastArg, ap );
+    
+#if (SG_DEBUG > 1)
+    {
+        int i, j;
+        for( i = 0 ; i < ctx->numUnaccGroups ; i++ )
+        {
+            for( j = ctx->unaccountedForIndex[i].start ; j < ctx->unaccountedForIndex[i].start + ctx->unaccountedForIndex[i].count ; j++ )
+            {
+                fprintf(stderr, "\t unaccountedFor group[%d] = %d <%s>\n", i, j, argv[j-1]);
+            }
+        }
+    }
+#endif
+    
+    if( usageCall == 1 && lastArg != NULL && *lastArg == 1 ) n = SG_ERROR_PRINT_USAGE;
+    else if( ctx->unAccountedFor && n != SG_ERROR_MISSING_ARG  && n != SG_ERROR_UNKNOWN_ARG)
+    {
+        n = placeExtras( ctx, argv, lastArg ); // not necessarily an error, just unaccounted for args
+    }
+    if( argv != NULL && argc > 0 ) n = applyEnv( ctx, ctx->spec, n, lastArg );
+    
+    sgCtxReportDiag( ctx );
+    return(n);
+}
+
+int superCtxVParseOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, va_list ap )
+{
+    int n;
+    int usageCall = 0;
+    
+    if( ctx == NULL ) return( SG_ERROR_MISSING_ARG );
+    sgCtxClearDiag( ctx );
+
+#if SG_ENABLE_RESPONSE_FILES
+    if( argv != NULL )
+    {
+        int badArg;
+
+        n = sgRspExpand( &ctx->rsp, argc, argv, 0, &argc, &argv, &badArg );
+        if( n < 0 )
+        {
+            if( lastArg ) *lastArg = badArg + 1;
+            sgCtxSetDiag( ctx, n, badArg + 1, NULL, -1, argv[badArg] );
+            sgCtxReportDiag( ctx );
+            return(n);
+        }
+    }
+#endif
+    startStrings( ctx, argc, argv );
+    ctx->argc = argc;
+    ctx->argv = argv;
+
+    if( argc == 0 || argv == NULL ) usageCall = 1;
+    
+    n = superParseInternal( ctx, argc, argv, usageCall, lastArg, ap );
+    
+    if( usageCall == 1 && *lastArg == 1 ) n = SG_ERROR_PRINT_USAGE;
+    else if( ctx->unAccountedFor )
+    {
+        n = placeExtras( ctx, argv, lastArg ); // not necessarily an error, just unaccounted for args
+    }
+    if( usageCall == 0 ) n = applyEnv( ctx, ctx->spec, n, lastArg );
+        
+    sgCtxReportDiag( ctx );
+    return(n);
+}
+
+int superCompileOpt( superOptSpec_t **pSpec, ... )
+{
+    va_list ap;
+    int n;
+
+    va_start( ap, pSpec );
+
+    n = superVCompileOpt( pSpec, ap );
+
+    va_end( ap );
+
+    return(n);
+}
+
+int superVCompileOpt( superOptSpec_t **pSpec, va_list ap )
+{
+    superOptSpec_t *spec;
+    int n;
+
+    if( pSpec == NULL ) return( SG_ERROR_MISSING_ARG );
+    *pSpec = NULL;
+
+    spec = (superOptSpec_t *) calloc( 1, sizeof(superOptSpec_t) );
+    SG_STATS_ADD( allocs, 1 );
+    if( spec == NULL ) return( SG_ERROR_NO_MEMORY );
+
+    n = compileSpec( spec, ap );
+    if( n < 0 )
+    {
+        /* the thread's last diag says which format was bad */
+        superOptCtx_t *ctx = getThreadCtx();
+        if( ctx != NULL )
+        {
+            sgCtxClearDiag( ctx );
+            sgCtxSetDiag( ctx, n, spec->optnum, NULL, -1, spec->badFormat );
+            sgCtxReportDiag( ctx );
+        }
+        superFreeOpt( spec );
+        return(n);
+    }
+
+    *pSpec = spec;
+    return(0);
+}
+
+int superCompileTable( superOptSpec_t **pSpec, const superOptDesc_t *table, int numOpts )
+{
+    superOptSpec_t *spec;
+    int n;
+
+    if( pSpec == NULL || (table == NULL && numOpts > 0) ) return( SG_ERROR_MISSING_ARG );
+    *pSpec = NULL;
+
+    spec = (superOptSpec_t *) calloc( 1, sizeof(superOptSpec_t) );
+    SG_STATS_ADD( allocs, 1 );
+    if( spec == NULL ) return( SG_ERROR_NO_MEMORY );
+
+    n = compileTable( spec, table, numOpts );
+    if( n < 0 )
+    {
+        superFreeOpt( spec );
+        return(n);
+    }
+
+    *pSpec = spec;
+    return(0);
+}
+
+int superParseSpec( const superOptSpec_t *spec, int argc, char **argv, int *lastArg )
+{
+    return( superCtxParseSpec( getThreadCtx(), spec, argc, argv, lastArg ) );
+}
+
+int superCtxParseSpec( superOptCtx_t *ctx, const superOptSpec_t *spec, int argc, char **argv, int *lastArg )
+{
+    int n;
+    int argDummy;
+
+    if( ctx == NULL || spec == NULL ) return( SG_ERROR_MISSING_ARG );
+    if( lastArg == NULL ) lastArg = &argDummy;
+    if( argv == NULL ) argc = 0;
+    sgCtxClearDiag( ctx );
+    startStrings( ctx, argc, argv );
+
+    // unlike superParseOpt, an empty argv is simply nothing to parse: use superUsageSpec() for usage
+    n = parseSpec( ctx, spec, argc, argv, 0, lastArg );
+
+    if( ctx->unAccountedFor && n != SG_ERROR_MISSING_ARG  && n != SG_ERROR_UNKNOWN_ARG)
+    {
+        n = placeExtras( ctx, argv, lastArg ); // not necessarily an error, just unaccounted for args
+    }
+    n = applyEnv( ctx, spec, n, lastArg );
+
+    sgCtxReportDiag( ctx );
+    return(n);
+}
+
+void superUsageSpec( const superOptSpec_t *spec )
+{
+    if( spec != NULL ) printUsage( spec );
+}
+
+void superFreeOpt( superOptSpec_t *spec )
+{
+    if( spec == NULL ) return;
+
+    freeUsage( spec );
+    free( spec->optionlist );
+    sgArenaRelease( &spec->arena );
+    free( spec );
+}
+
+superOptCtx_t *superCtxNew( void )
+{
+    superOptCtx_t *ctx = (superOptCtx_t *) malloc( sizeof(superOptCtx_t) );
+    SG_STATS_ADD( allocs, 1 );
+
+    if( ctx == NULL ) return( NULL );
+
+    superCtxInit( ctx, sizeof(superOptCtx_t) );
+    ctx->ownsSelf = 1;
+    return( ctx );
+}
+
+size_t superCtxSize( void )
+{
+    return( sizeof(superOptCtx_t) );
+}
+
+superOptCtx_t *superCtxInit( void *mem, size_t size )
+{
+    superOptCtx_t *ctx = (superOptCtx_t *) mem;
+
+    if( ctx == NULL || size < sizeof(superOptCtx_t) ) return( NULL );
+
+    memset( ctx, 0, sizeof(superOptCtx_t) );
+    ctx->diagMode = SG_DEBUG ? SG_DIAG_STDERR : SG_DIAG_QUIET;
+    sgCtxClearDiag( ctx );
+    return( ctx );
+}
+
+void superCtxRelease( superOptCtx_t *ctx )
+{
+    if( ctx == NULL ) return;
+
+    superFreeOpt( ctx->spec );
+    ctx->spec = NULL;
+    sgEnvRelease( &ctx->env );
+    free( ctx->unaccountedForIndex );
+    ctx->unaccountedForIndex = NULL;
+    ctx->unaccGroupsCap = 0;
+    ctx->numUnaccGroups = 0;
+    ctx->unAccountedFor = 0;
+    free( ctx->extraArgs );
+    ctx->extraArgs = NULL;
+    ctx->extraArgsCap = 0;
+    free( ctx->argptr );
+    ctx->argptr = NULL;
+    ctx->argptrCap = 0;
+    sgRspRelease( &ctx->rsp );
+    sgArenaRelease( &ctx->strings );
+    freeLists( ctx, 0 );
+    free( ctx->grown );
+    ctx->grown = NULL;
+    ctx->grownCap = 0;
+    ctx->argc = 0;
+    ctx->argv = NULL;
+}
+
+void superCtxFree( superOptCtx_t *ctx )
+{
+    if( ctx == NULL ) return;
+
+    superCtxRelease( ctx );
+    if( ctx->ownsSelf ) free( ctx );
+}
+
+void superCtxUsage( superOptCtx_t *ctx )
+{
+    if( ctx != NULL && ctx->spec != NULL ) printUsage( ctx->spec );
+}
+
+char **superCtxArgv( superOptCtx_t *ctx, int *argc )
+{
+    if( ctx == NULL ) return( NULL );
+    if( argc ) *argc = ctx->argc;
+    return( ctx->argv );
+}
+
+char **superArgv( int *argc )
+{
+    return( superCtxArgv( getThreadCtx(), argc ) );
+}
+
+void superCtxSetExtrasMode( superOptCtx_t *ctx, int mode )
+{
+    if( ctx != NULL ) ctx->extrasMode = mode;
+}
+
+void superSetExtrasMode( int mode )
+{
+    superCtxSetExtrasMode( getThreadCtx(), mode );
+}
+
+void superCtxSetNameMode( superOptCtx_t *ctx, int mode )
+{
+    if( ctx != NULL ) ctx->nameMode = mode;
+}
+
+void superSetNameMode( int mode )
+{
+    superCtxSetNameMode( getThreadCtx(), mode );
+}
+
+void superCtxSetEnvPrefix( superOptCtx_t *ctx, const char *prefix )
+{
+    if( ctx != NULL ) ctx->env.prefix = prefix;
+}
+
+void superSetEnvPrefix( const char *prefix )
+{
+    superCtxSetEnvPrefix( getThreadCtx(), prefix );
+}
+
+void superCtxSetStringMode( superOptCtx_t *ctx, int mode )
+{
+    if( ctx != NULL ) ctx->stringMode = mode;
+}
+
+void superSetStringMode( int mode )
+{
+    superCtxSetStringMode( getThreadCtx(), mode );
+}
+
+void superCtxSetDiagMode( superOptCtx_t *ctx, int mode )
+{
+    if( ctx != NULL ) ctx->diagMode = mode;
+}
+
+void superSetDiagMode( int mode )
+{
+    superCtxSetDiagMode( getThreadCtx(), mode );
+}
+
+const superDiag_t *superCtxLastDiag( const superOptCtx_t *ctx )
+{
+    return( ctx ? &ctx->diag : NULL );
+}
+
+const superDiag_t *superLastDiag( void )
+{
+    return( superCtxLastDiag( getThreadCtx() ) );
+}
+
+static const char *const errorStrings[] =
+{
+    "no error", "usage requested", "too many options", "bad format", "bad format type",
+    "bad argument type", "bad var list type", "incorrect argument", "missing argument",
+    "no formats", "mixed types in var list", "zero length option", "too many arguments",
+    "unknown option", "out of memory", "bad binding", "response file error", "ambiguous option"
+};
+
+const char *superErrorString( int code )
+{
+    if( code > 0 || -code >= (int) (sizeof(errorStrings) / sizeof(errorStrings[0])) ) return( "unknown error" );
+    return( errorStrings[-code] );
+}
+
+/* vsnprintf onto the end of buf, counting what doesn't fit the way snprintf does */
+static void appendText( char *buf, size_t size, int *len, const char *fmt, ... )
+{
+    va_list ap;
+    int n;
+
+    va_start( ap, fmt );
+    n = vsnprintf( (size_t) *len < size ? buf + *len : NULL, (size_t) *len < size ? size - *len : 0, fmt, ap );
+    va_end( ap );
+    if( n > 0 ) *len += n;
+}
+
+int superFormatDiag( const superDiag_t *diag, char *buf, size_t size )
+{
+    int len = 0;
+
+    if( size > 0 ) buf[0] = 0;
+    if( diag == NULL ) return(0);
+
+    if( diag->code != 0 )
+    {
+        if( diag->source != NULL ) appendText( buf, size, &len, diag->argIndex > 0 ? "%s:%d" : "%s", diag->source, diag->argIndex );
+        else if( diag->argIndex > 0 ) appendText( buf, size, &len, "arg %d", diag->argIndex );
+        if( diag->token[0] ) appendText( buf, size, &len, len ? " <%s>" : "<%s>", diag->token );
+        appendText( buf, size, &len, "%s%s", len ? ": " : "", superErrorString( diag->code ) );
+        if( diag->option != NULL ) appendText( buf, size, &len, " for %s", diag->option );
+        if( diag->expectedType >= 0 && diag->expectedType < NUMTYPES ) appendText( buf, size, &len, " (expected %s)", expectedNames[diag->expectedType] );
+    }
+    if( diag->dropped > 0 )
+    {
+        appendText( buf, size, &len, "%s%d value%s past the end of %s ignored", len ? "; " : "",
+            diag->dropped, diag->dropped == 1 ? "" : "s", diag->droppedOption );
+    }
+    return( len );
+}
+
+void superPrintDiag( const superDiag_t *diag )
+{
+    char text[256];
+
+    if( superFormatDiag( diag, text, sizeof(text) ) > 0 ) fprintf( stderr, "%s\n", text );
+}
+
+const superArgSpan_t *superCtxExtraSpans( superOptCtx_t *ctx, int *numSpans )
+{
+    if( numSpans ) *numSpans = ctx ? ctx->numUnaccGroups : 0;
+    if( ctx == NULL || ctx->numUnaccGroups == 0 ) return( NULL );
+    return( ctx->unaccountedForIndex );
+}
+
+const superArgSpan_t *superExtraSpans( int *numSpans )
+{
+    return( superCtxExtraSpans( getThreadCtx(), numSpans ) );
+}
+
+/* superGetOpt and friends keep their state (and the formats for usage()) per thread */
+#if defined(_WIN32)
+
+static __declspec(thread) superOptCtx_t *threadCtx;
+
+static superOptCtx_t *getThreadCtx( void )
+{
+    if( threadCtx == NULL ) threadCtx = superCtxNew();
+    return( threadCtx );
+}
+
+#else
+
+static pthread_key_t threadCtxKey;
+static pthread_once_t threadCtxOnce = PTHREAD_ONCE_INIT;
+
+static void freeThreadCtx( void *ctx )
+{
+    superCtxFree( (superOptCtx_t *) ctx );
+}
+
+static void makeThreadCtxKey( void )
+{
+    pthread_key_create( &threadCtxKey, freeThreadCtx );
+}
+
+static superOptCtx_t *getThreadCtx( void )
+{
+    superOptCtx_t *ctx;
+
+    pthread_once( &threadCtxOnce, makeThreadCtxKey );
+    ctx = (superOptCtx_t *) pthread_getspecific( threadCtxKey );
+    if( ctx == NULL )
+    {
+        ctx = superCtxNew();
+        pthread_setspecific( threadCtxKey, ctx );
+    }
+    return( ctx );
+}
+
+#endif
+
+superOptCtx_t *sgThreadCtx( void )
+{
+    return( getThreadCtx() );
+}
+
+/* batch parses write each record's values at the same offsets from its own outBase */
+static void *relocate( const superOptCtx_t *ctx, void *p )
+{
+    uintptr_t off;
+
+    if( ctx->outBase == NULL || p == NULL ) return( p );
+
+    off = (uintptr_t) p - (uintptr_t) ctx->bindBase;
+    return( off < ctx->bindSize ? ctx->outBase + off : p );
+}
+
+void sgCtxSetOutput( superOptCtx_t *ctx, const void *bindBase, size_t bindSize, void *outBase )
+{
+    ctx->bindBase = (const char *) bindBase;
+    ctx->bindSize = bindSize;
+    ctx->outBase = (char *) outBase;
+}
+
+int sgCtxInBatch( const superOptCtx_t *ctx )
+{
+    return( ctx->outBase != NULL );
+}
+
+void sgCtxCopyModes( superOptCtx_t *ctx, const superOptCtx_t *from )
+{
+    ctx->extrasMode = from->extrasMode;
+    ctx->nameMode = from->nameMode;
+    ctx->diagMode = from->diagMode;
+    ctx->env.prefix = from->env.prefix;
+}
+
+/* string values point into argv, or into the context when argv is a reused buffer */
+static char *keepString( superOptCtx_t *ctx, char *s )
+{
+    if( !ctx->lineMode && ctx->stringMode == SG_STRINGS_ARGV ) return( s );
+    return( sgArenaStrdup( &ctx->strings, s ) );
+}
+
+/* a parse that copies its strings makes room for all of argv up front: one malloc at most,
+    and none once a block that big is kept from an earlier parse. A usage call (no argv)
+    leaves the last parse's strings alone */
+static void startStrings( superOptCtx_t *ctx, int argc, char **argv )
+{
+    size_t size = 0;
+    int k;
+
+    if( ctx->stringMode == SG_STRINGS_ARGV || argv == NULL ) return;
+    sgCtxResetStrings( ctx );
+    for( k = 0 ; k < argc ; k++ ) size += strlen( argv[k] ) + 1;
+    if( size > 0 ) sgArenaReserve( &ctx->strings, size, argc );
+}
+
+int sgParseLine( superOptCtx_t *ctx, const superOptSpec_t *spec, int argc, char **argv, int first, int *lastArg )
+{
+    int n;
+
+    ctx->lineMode = 1;
+    ctx->keepVarCounts = !first;
+    n = parseSpec( ctx, spec, argc, argv, 0, lastArg );
+    ctx->lineMode = 0;
+    ctx->keepVarCounts = 0;
+
+    /* a line is one option and its values: anything left over is an error */
+    if( n >= 0 && ctx->unAccountedFor > 0 )
+    {
+        if( lastArg ) *lastArg = ctx->unaccountedForIndex[0].start;
+        n = sgCtxSetDiag( ctx, SG_ERROR_UNKNOWN_ARG, ctx->unaccountedForIndex[0].start, NULL, -1, argv[ctx->unaccountedForIndex[0].start - 1] );
+    }
+
+    return(n);
+}
+
+void sgCtxResetStrings( superOptCtx_t *ctx )
+{
+    if( ctx->stringMode != SG_STRINGS_KEEP ) sgArenaReset( &ctx->strings );
+}
+
+void superCtxFreeStrings( superOptCtx_t *ctx )
+{
+    if( ctx != NULL ) sgArenaRelease( &ctx->strings );
+}
+
+void superFreeStrings( void )
+{
+    superCtxFreeStrings( getThreadCtx() );
+}
+
+/* options whose count each parse starts again: var lists and SG_BIND_GROW options */
+static int counted( const struct optionlist_s *o )
+{
+    return( (o->varflag == 1 && o->bind != SG_BIND_SINK) || o->bind == SG_BIND_GROW );
+}
+
+/* make room for value n in the SG_BIND_GROW array at *where, doubling it as it fills: a
+    NULL *where is a new array. Each array belongs to the context that grew it first */
+static int growColumn( superOptCtx_t *ctx, char **where, size_t size, int n )
+{
+    growHeader_t *h = *where != NULL ? (growHeader_t *) *where - 1 : NULL;
+    grownArray_t *list;
+    size_t cap;
+    int slot;
+
+    if( h != NULL && h->h.owner != ctx ) return( SG_ERROR_BAD_BINDING );
+    if( h != NULL && (size_t) n < h->h.cap ) return(0);
+
+    for( cap = h != NULL ? 2 * h->h.cap : FIRST_GROW ; cap <= (size_t) n ; cap *= 2 ) ;
+    if( h == NULL && ctx->numGrown == ctx->grownCap )
+    {
+        int listCap = ctx->grownCap ? 2 * ctx->grownCap : FIRST_GROW;
+
+        list = (grownArray_t *) realloc( ctx->grown, listCap * sizeof(grownArray_t) );
+        SG_STATS_ADD( allocs, 1 );
+        if( list == NULL ) return( SG_ERROR_NO_MEMORY );
+        ctx->grown = list;
+        ctx->grownCap = listCap;
+    }
+    slot = h != NULL ? h->h.slot : ctx->numGrown;
+
+    h = (growHeader_t *) realloc( h, sizeof(growHeader_t) + cap * size );
+    SG_STATS_ADD( allocs, 1 );
+    if( h == NULL ) return( SG_ERROR_NO_MEMORY );
+    if( slot == ctx->numGrown ) ctx->numGrown++;
+
+    h->h.cap = cap;
+    h->h.slot = slot;
+    h->h.owner = ctx;
+    ctx->grown[slot].where = where;
+    ctx->grown[slot].block = h;
+    *where = (char *) (h + 1);
+    return(0);
+}
+
+/* a context being released leaves the pointers alone: they may be gone by then */
+static void freeLists( superOptCtx_t *ctx, int clear )
+{
+    int k;
+
+    for( k = 0 ; k < ctx->numGrown ; k++ )
+    {
+        free( ctx->grown[k].block );
+        if( clear ) *ctx->grown[k].where = NULL;
+    }
+    ctx->numGrown = 0;
+}
+
+void superCtxFreeLists( superOptCtx_t *ctx )
+{
+    if( ctx != NULL ) freeLists( ctx, 1 );
+}
+
+void superFreeLists( void )
+{
+    superCtxFreeLists( getThreadCtx() );
+}
+
+int sgFindOption( const superOptSpec_t *spec, const char *name )
+{
+    return( lookupOption( spec, name ) );
+}
+
+int sgIsOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, char *s )
+{
+    return( check_if_option( ctx, s, spec ) >= 0 );
+}
+
+int sgCtxFindOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, const char *name )
+{
+    int i = findOption( ctx, spec, name );
+
+    return( i == SG_AMBIGUOUS ? SG_ERROR_AMBIGUOUS_ARG : i );
+}
+
+int sgAttachedOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, char *s )
+{
+    char *value, *bundle;
+    int i = attachedOption( ctx, spec, s, &value, &bundle );
+
+    if( i == SG_AMBIGUOUS ) return( SG_ERROR_AMBIGUOUS_ARG );
+    return( i >= 0 && value != NULL ? i : -1 );
+}
+
+int sgNumOptions( const superOptSpec_t *spec )
+{
+    return( spec->optnum );
+}
+
+int sgOptionArgs( const superOptSpec_t *spec, int opt, int *varflag )
+{
+    *varflag = spec->optionlist[opt].varflag;
+    return( spec->optionlist[opt].numargs );
+}
+
+int sgParseOption( superOptCtx_t *ctx, const superOptSpec_t *spec, int opt, int first, int argc, char **argv, int *lastArg )
+{
+    const struct optionlist_s *o = &spec->optionlist[opt];
+    int unAccountedFor, numUnaccGroups;
+    int n;
+
+    if( first && counted( o ) ) *(int *) relocate( ctx, o->pNumArgs ) = 0;
+    if( argc == 0 ) return(0);
+
+    /* the extra args of a parse this one is part of (an environment variable's) are kept */
+    unAccountedFor = ctx->unAccountedFor;
+    numUnaccGroups = ctx->numUnaccGroups;
+    ctx->keepVarCounts = 1;
+    n = parseSpec( ctx, spec, argc, argv, 0, lastArg );
+    ctx->keepVarCounts = 0;
+    ctx->unAccountedFor = unAccountedFor;
+    ctx->numUnaccGroups = numUnaccGroups;
+    return(n);
+}
+
+int sgOptionHasString( const superOptSpec_t *spec, int opt )
+{
+    const struct optionlist_s *o = &spec->optionlist[opt];
+    int k;
+
+    for( k = 0 ; k < o->numargs ; k++ ) if( o->argtype[k] == STRING ) return(1);
+    return(0);
+}
+
+const char *sgOptionName( const superOptSpec_t *spec, int opt )
+{
+    return( spec->optionlist[opt].name );
+}
+
+void sgCtxClearDiag( superOptCtx_t *ctx )
+{
+    memset( &ctx->diag, 0, sizeof(ctx->diag) );
+    ctx->diag.expectedType = -1;
+}
+
+int sgCtxSetDiag( superOptCtx_t *ctx, int code, int argIndex, const char *option, int type, const char *token )
+{
+    superDiag_t *d = &ctx->diag;
+
+    d->code = code;
+    d->argIndex = argIndex;
+    d->option = option;
+    d->expectedType = type;
+    d->token[0] = 0;
+    if( token != NULL )
+    {
+        strncpy( d->token, token, sizeof(d->token) - 1 );
+        d->token[sizeof(d->token) - 1] = 0;
+    }
+    return( code );
+}
+
+superDiag_t *sgCtxDiag( superOptCtx_t *ctx )
+{
+    return( &ctx->diag );
+}
+
+int sgCtxDiagMode( const superOptCtx_t *ctx )
+{
+    return( ctx->diagMode );
+}
+
+void sgCtxReportDiag( const superOptCtx_t *ctx )
+{
+    if( ctx->diagMode == SG_DIAG_STDERR && (ctx->diag.code != 0 || ctx->diag.dropped > 0) ) superPrintDiag( &ctx->diag );
+}
+
+/* after a parse that went well: options argv didn't give, from the environment.
+    A bad variable is the parse's error, with argPos 0 */
+static int applyEnv( superOptCtx_t *ctx, const superOptSpec_t *spec, int n, int *lastArg )
+{
+    int e;
+
+    if( n < 0 || spec == NULL || ctx->env.prefix == NULL ) return(n);
+
+    e = sgEnvApply( ctx, &ctx->env, spec );
+    if( e < 0 )
+    {
+        if( lastArg ) *lastArg = 0;
+        return(e);
+    }
+    return(n);
+}
+
+/* a value past the end of its array: ignored, only counted */
+static void dropValue( superOptCtx_t *ctx, const char *option )
+{
+    if( ctx->diag.dropped++ == 0 ) ctx->diag.droppedOption = option;
+}
+
+static size_t typeSize( int type )
+{
+    switch( type )
+    {
+        case CHAR:   return( sizeof(char) );
+        case SHORT:  return( sizeof(short) );
+        case INT:    return( sizeof(int) );
+        case UINT:
+        case HEX:    return( sizeof(unsigned int) );
+        case LINT:   return( sizeof(long) );
+        case FLOAT:  return( sizeof(float) );
+        case DOUBLE: return( sizeof(double) );
+        case SIZE:   return( sizeof(unsigned long long) );
+        case DURATION: return( sizeof(long long) );
+    }
+    return(0);
+}
+
+/* saved values are packed bytes: numbers as they are, strings as a set flag, length and
+    the characters with their terminator, lists as a count and then the values. A raw save
+    keeps each string's pointer instead of its characters (flag 2), to put back as it was */
+static void saveBytes( char *buf, size_t cap, size_t *pos, const void *p, size_t n )
+{
+    if( buf != NULL && *pos + n <= cap ) memcpy( buf + *pos, p, n );
+    *pos += n;
+}
+
+static void saveString( char *buf, size_t cap, size_t *pos, const char *s, size_t len, int raw )
+{
+    char set = s == NULL ? 0 : raw ? 2 : 1;
+
+    saveBytes( buf, cap, pos, &set, 1 );
+    if( s == NULL ) return;
+    saveBytes( buf, cap, pos, &len, sizeof(len) );
+    if( raw )
+    {
+        saveBytes( buf, cap, pos, &s, sizeof(s) );
+        return;
+    }
+    saveBytes( buf, cap, pos, s, len );
+    saveBytes( buf, cap, pos, "", 1 );
+}
+
+static void saveValue( char *buf, size_t cap, size_t *pos, int type, PANYTYPE p, int k, int raw )
+{
+    if( type == STRING ) saveString( buf, cap, pos, p.string[k], p.string[k] ? strlen( p.string[k] ) : 0, raw );
+    else saveBytes( buf, cap, pos, p.c + k * typeSize( type ), typeSize( type ) );
+}
+
+/* a saved string: points into buf, or where it pointed when saved raw */
+static char *restoreString( char *buf, size_t *pos, size_t *pLen )
+{
+    size_t len = 0;
+    char *s = NULL;
+    char set = buf[(*pos)++];
+
+    if( set == 2 )
+    {
+        memcpy( &len, buf + *pos, sizeof(len) );
+        memcpy( &s, buf + *pos + sizeof(len), sizeof(s) );
+        *pos += sizeof(len) + sizeof(s);
+    }
+    else if( set )
+    {
+        memcpy( &len, buf + *pos, sizeof(len) );
+        s = buf + *pos + sizeof(len);
+        *pos += sizeof(len) + len + 1;
+    }
+    if( pLen ) *pLen = len;
+    return(s);
+}
+
+static void restoreValue( char *buf, size_t *pos, int type, PANYTYPE p, int k )
+{
+    if( type == STRING ) p.string[k] = restoreString( buf, pos, NULL );
+    else
+    {
+        memcpy( p.c + k * typeSize( type ), buf + *pos, typeSize( type ) );
+        *pos += typeSize( type );
+    }
+}
+
+#ifdef __cplusplus
+template<class T> static void saveElems( char *buf, size_t cap, size_t *pos, const std::vector<T> *v )
+{
+    size_t n = v->size();
+
+    saveBytes( buf, cap, pos, &n, sizeof(n) );
+    if( n > 0 ) saveBytes( buf, cap, pos, v->data(), n * sizeof(T) );
+}
+
+template<class T> static void restoreElems( char *buf, size_t *pos, std::vector<T> *v )
+{
+    size_t n;
+
+    memcpy( &n, buf + *pos, sizeof(n) );
+    *pos += sizeof(n);
+    v->resize( n );
+    if( n > 0 ) memcpy( v->data(), buf + *pos, n * sizeof(T) );
+    *pos += n * sizeof(T);
+}
+
+static void saveVector( char *buf, size_t cap, size_t *pos, int type, int bind, PANYTYPE p, int raw )
+{
+    size_t k, n;
+
+    switch( type )
+    {
+        case CHAR:   saveElems( buf, cap, pos, p.vc ); break;
+        case SHORT:  saveElems( buf, cap, pos, p.vh ); break;
+        case INT:    saveElems( buf, cap, pos, p.vi ); break;
+        case UINT:
+        case HEX:    saveElems( buf, cap, pos, p.vui ); break;
+        case LINT:   saveElems( buf, cap, pos, p.vli ); break;
+        case FLOAT:  saveElems( buf, cap, pos, p.vf ); break;
+        case DOUBLE: saveElems( buf, cap, pos, p.vd ); break;
+        case SIZE:   saveElems( buf, cap, pos, p.vull ); break;
+        case DURATION: saveElems( buf, cap, pos, p.vll ); break;
+        case STRING:
+#if __cplusplus >= 201703L
+            if( bind == SG_BIND_VIEWS )
+            {
+                n = p.vsv->size();
+                saveBytes( buf, cap, pos, &n, sizeof(n) );
+                for( k = 0 ; k < n ; k++ ) saveString( buf, cap, pos, (*p.vsv)[k].data(), (*p.vsv)[k].size(), raw );
+                break;
+            }
+#endif
+            n = p.vcp->size();
+            saveBytes( buf, cap, pos, &n, sizeof(n) );
+            for( k = 0 ; k < n ; k++ ) saveString( buf, cap, pos, (*p.vcp)[k], strlen( (*p.vcp)[k] ), raw );
+            break;
+    }
+}
+
+static void restoreVector( char *buf, size_t *pos, int type, int bind, PANYTYPE p )
+{
+    size_t k, n, len;
+
+    switch( type )
+    {
+        case CHAR:   restoreElems( buf, pos, p.vc ); break;
+        case SHORT:  restoreElems( buf, pos, p.vh ); break;
+        case INT:    restoreElems( buf, pos, p.vi ); break;
+        case UINT:
+        case HEX:    restoreElems( buf, pos, p.vui ); break;
+        case LINT:   restoreElems( buf, pos, p.vli ); break;
+        case FLOAT:  restoreElems( buf, pos, p.vf ); break;
+        case DOUBLE: restoreElems( buf, pos, p.vd ); break;
+        case SIZE:   restoreElems( buf, pos, p.vull ); break;
+        case DURATION: restoreElems( buf, pos, p.vll ); break;
+        case STRING:
+            memcpy( &n, buf + *pos, sizeof(n) );
+            *pos += sizeof(n);
+#if __cplusplus >= 201703L
+            if( bind == SG_BIND_VIEWS )
+            {
+                p.vsv->clear();
+                for( k = 0 ; k < n ; k++ )
+                {
+                    char *s = restoreString( buf, pos, &len );
+                    p.vsv->push_back( std::string_view( s, len ) );
+                }
+                break;
+            }
+#endif
+            p.vcp->clear();
+            for( k = 0 ; k < n ; k++ ) p.vcp->push_back( restoreString( buf, pos, &len ) );
+            break;
+    }
+}
+#endif
+
+size_t sgSaveOption( const superOptSpec_t *spec, int opt, char *buf, size_t cap, int raw )
+{
+    const struct optionlist_s *o = &spec->optionlist[opt];
+    PANYTYPE col;
+    size_t pos = 0;
+    int f, j, n;
+
+    if( o->bind == SG_BIND_SINK ) return(0);
+    if( o->numargs == 0 )
+    {
+        saveBytes( buf, cap, &pos, o->argptr[0].i, sizeof(int) );
+        return( pos );
+    }
+    if( o->bind == SG_BIND_GROW )
+    {
+        /* the values the arrays point at, as for a list; none once superFreeLists let them go */
+        n = *o->argptr[0].string != NULL && *o->pNumArgs > 0 ? *o->pNumArgs : 0;
+        saveBytes( buf, cap, &pos, &n, sizeof(n) );
+        for( f = 0 ; f < o->numargs ; f++ )
+        {
+            col.c = *o->argptr[f].string;
+            for( j = 0 ; j < n ; j++ ) saveValue( buf, cap, &pos, o->argtype[f], col, j, raw );
+        }
+        return( pos );
+    }
+    if( o->varflag != 1 )
+    {
+        for( j = 0 ; j < o->numargs ; j++ ) saveValue( buf, cap, &pos, o->argtype[j], o->argptr[j], 0, raw );
+        return( pos );
+    }
+#ifdef __cplusplus
+    if( o->bind == SG_BIND_VECTOR || o->bind == SG_BIND_VIEWS )
+    {
+        for( f = 0 ; f < o->numargs ; f++ ) saveVector( buf, cap, &pos, o->argtype[f], o->bind, o->argptr[f], raw );
+        return( pos );
+    }
+#endif
+    n = *o->pNumArgs;
+    if( n > o->numArgsMax ) n = o->numArgsMax;
+    if( n < 0 ) n = 0;
+    saveBytes( buf, cap, &pos, &n, sizeof(n) );
+    for( f = 0 ; f < o->numargs ; f++ )
+    {
+        for( j = 0 ; j < n ; j++ ) saveValue( buf, cap, &pos, o->argtype[f], o->argptr[f], j, raw );
+    }
+    return( pos );
+}
+
+void sgRestoreOption( const superOptSpec_t *spec, int opt, char *buf )
+{
+    const struct optionlist_s *o = &spec->optionlist[opt];
+    PANYTYPE col;
+    size_t pos = 0;
+    int f, j, n;
+
+    if( o->bind == SG_BIND_SINK ) return;
+    if( o->numargs == 0 )
+    {
+        memcpy( o->argptr[0].i, buf, sizeof(int) );
+        return;
+    }
+    if( o->bind == SG_BIND_GROW )
+    {
+        /* the arrays never shrink, so they still hold as many values as they did */
+        memcpy( &n, buf, sizeof(n) );
+        pos = sizeof(n);
+        if( *o->argptr[0].string == NULL ) n = 0;
+        *o->pNumArgs = n;
+        for( f = 0 ; f < o->numargs ; f++ )
+        {
+            col.c = *o->argptr[f].string;
+            for( j = 0 ; j < n ; j++ ) restoreValue( buf, &pos, o->argtype[f], col, j );
+        }
+        return;
+    }
+    if( o->varflag != 1 )
+    {
+        for( j = 0 ; j < o->numargs ; j++ ) restoreValue( buf, &pos, o->argtype[j], o->argptr[j], 0 );
+        return;
+    }
+#ifdef __cplusplus
+    if( o->bind == SG_BIND_VECTOR || o->bind == SG_BIND_VIEWS )
+    {
+        for( f = 0 ; f < o->numargs ; f++ ) restoreVector( buf, &pos, o->argtype[f], o->bind, o->argptr[f] );
+        return;
+    }
+#endif
+    memcpy( &n, buf, sizeof(n) );
+    pos = sizeof(n);
+    *o->pNumArgs = n;
+    for( f = 0 ; f < o->numargs ; f++ )
+    {
+        for( j = 0 ; j < n ; j++ ) restoreValue( buf, &pos, o->argtype[f], o->argptr[f], j );
+    }
+}
+
+int sgSpecBoundWithin( const superOptSpec_t *spec, const void *base, size_t size )
+{
+    uintptr_t b = (uintptr_t) base;
+    int i, j;
+
+    for( i = 0 ; i < spec->optnum ; i++ )
+    {
+        const struct optionlist_s *opt = &spec->optionlist[i];
+
+        if( opt->bind == SG_BIND_SINK ) continue;      /* writes nothing itself */
+        if( opt->bind == SG_BIND_GROW ) return(0);     /* its arrays would belong to a worker */
+        for( j = 0 ; j < opt->numargs || j == 0 ; j++ )
+        {
+            if( (uintptr_t) opt->argptr[j].c - b >= size ) return(0);
+        }
+        if( opt->varflag == 1 && (uintptr_t) opt->pNumArgs - b >= size ) return(0);
+    }
+    return(1);
+}
+
+static int superParseInternal( superOptCtx_t *ctx, int argc, char **argv, int usageCall, int *lastArg, va_list ap )
+{
+    int return_val;
+    va_list aq;
+    char *first;
+
+    ctx->unAccountedFor = 0; // args not associated with detected flags
+    ctx->numUnaccGroups = 0;
+
+    if( lastArg ) *lastArg = 0;
+
+    if( argv == NULL ) argc = 0;
+
+    // a usage call without formats re-prints the ones from the previous call
+    va_copy( aq, ap );
+    first = va_arg( aq, char * );
+    va_end( aq );
+
+    if( argc != 0 || first != NULL )
+    {
+        if( ctx->spec == NULL )
+        {
+            ctx->spec = (superOptSpec_t *) calloc( 1, sizeof(superOptSpec_t) );
+            SG_STATS_ADD( allocs, 1 );
+            if( ctx->spec == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+        }
+
+        return_val = compileSpec( ctx->spec, ap );
+        if( return_val < 0 )
+        {
+            if( lastArg ) *lastArg = ctx->spec->optnum;
+            sgCtxSetDiag( ctx, return_val, ctx->spec->optnum, NULL, -1, ctx->spec->badFormat );
+            ctx->spec->optnum = 0;
+            return( return_val );
+        }
+    }
+
+    if( ctx->spec == NULL ) return(0);
+
+    // user can tell us to print usage by calling with NULL or argc = 0 or both
+    if( argv == NULL || argc == 0 /*|| usageCall == 1*/ )
+    {
+        printUsage( ctx->spec );
+        return(0);
+    }
+
+    return( parseSpec( ctx, ctx->spec, argc, argv, usageCall, lastArg ) );
+}
+
+/* parse all passed-in option formats and bind the caller's pointers to them */
+static int compileSpec( superOptSpec_t *spec, va_list ap )
+{
+    char *optstring;
+    int i;
+    int noName;
+    struct optionlist_s *opt;
+
+    /* a spec being recompiled keeps its option slots and its arena's largest block */
+    spec->optnum = 0;
+    spec->maxArgs = 1;
+    spec->hashSlot = NULL;
+    spec->hashVal = NULL;
+    spec->badFormat = NULL;
+    freeUsage( spec );
+    sgArenaReset( &spec->arena );
+
+    while( (optstring = (char *) va_arg(ap, char *)) != (char *) NULL )
+    { 
+        opt = newOption( spec );
+        if( opt == NULL ) return( SG_ERROR_NO_MEMORY );
+
+        SG_STATS_START( t );
+        opt->numargs = parse_string(optstring, opt, &noName, &spec->arena);
+        SG_STATS_STOP( formatNs, t );
+#if (SG_DEBUG > 3)
+        fprintf(stderr, "Num args to option = %d for <%s>\n",opt->numargs,optstring);
+#endif
+        if( opt->numargs < 0 )
+        {
+            spec->badFormat = optstring;
+            return( opt->numargs );
+        }
+
+        opt->argptr = (PANYTYPE *) sgArenaAlloc( &spec->arena, (opt->numargs > 0 ? opt->numargs : 1) * sizeof(PANYTYPE) );
+        if( opt->argptr == NULL ) return( SG_ERROR_NO_MEMORY );
+        if( opt->numargs > spec->maxArgs ) spec->maxArgs = opt->numargs;
+
+        // a sink and its user pointer stand in for all the value pointers
+        if( opt->bind == SG_BIND_SINK )
+        {
+            opt->sink = va_arg(ap, superSink_t);
+            opt->sinkUser = va_arg(ap, void *);
+            if( opt->sink == NULL ) return( SG_ERROR_MISSING_ARG );
+        }
+
+        for( i = 0 ; i < opt->numargs && opt->bind != SG_BIND_SINK ; i++ )
+        {
+#if (SG_DEBUG > 3)
+            fprintf(stderr,"Looping through numargs=%d at iter=%d var=%d\n", opt->numargs, i, opt->varflag);
+#endif
+            switch( opt->argtype[i] )
+            {
+            case CHAR: 
+                opt->argptr[i].c = va_arg(ap, char *);
+                break;
+            case SHORT: 
+                opt->argptr[i].h = va_arg(ap, short *);
+                break;
+            case INT: 
+                opt->argptr[i].i = va_arg(ap, int *);
+                break;
+            case UINT:
+            case HEX:
+                opt->argptr[i].ui = va_arg(ap, unsigned int *);
+                break;
+            case LINT:
+                opt->argptr[i].li = va_arg(ap, long *);
+                break;
+            case FLOAT: 
+                opt->argptr[i].f = va_arg(ap, float *);
+                break;
+            case DOUBLE: 
+                opt->argptr[i].d = va_arg(ap, double *);
+                break;
+            case SIZE:
+                opt->argptr[i].ull = va_arg(ap, unsigned long long *);
+                break;
+            case DURATION:
+                opt->argptr[i].ll = va_arg(ap, long long *);
+                break;
+            case STRING: 
+                opt->argptr[i].string = va_arg(ap, char **);
+                break;
+            }
+
+            if( opt->varflag == 1 || opt->bind == SG_BIND_GROW )
+            {
+                // for vararg formats, the array pointer is followed by a pointer to numArgs.
+                // A tuple list has one array per field, then the one count. So does a "+"
+                // option, with a pointer to each array the library grows
+                if( opt->argptr[i].c == NULL ) return( SG_ERROR_MISSING_ARG );
+                if( i < opt->numargs - 1 ) continue;
+
+                opt->pNumArgs = va_arg(ap, int *);
+                if( opt->pNumArgs == NULL ) return( SG_ERROR_MISSING_ARG );
+                if( opt->bind == SG_BIND_GROW ) continue;       /* no limit, and the count needn't be set */
+                opt->numArgsMax = *opt->pNumArgs;
+#ifdef __cplusplus
+                if( opt->numArgsMax == 0 ) opt->bind = SG_BIND_VECTOR;   /* numArgs 0: a std::vector */
+#endif
+#if (SG_DEBUG > 3)
+                fprintf(stderr, "Varargs pNumArgs=%p %d\n", (void *) opt->pNumArgs, *opt->pNumArgs);
+#endif
+            }
+        }
+        
+        // flagless arg (like -help)
+        if( opt->numargs == 0 )
+        {
+            opt->argptr[0].i = va_arg(ap, int *);
+        }
+
+#if SG_ENABLE_HELPSTRING
+        // get help string
+        opt->helpString = va_arg(ap, char *);
+#endif
+        spec->optnum++;
+    }
+
+    return( buildNameIndex( spec ) );
+}
+
+/* the next option slot of a spec being compiled, blank */
+static struct optionlist_s *newOption( superOptSpec_t *spec )
+{
+    struct optionlist_s *opt;
+
+    if( spec->optnum == spec->optCap )
+    {
+        int cap = spec->optCap ? 2 * spec->optCap : FIRST_OPTS;
+        struct optionlist_s *list = (struct optionlist_s *) realloc( spec->optionlist, cap * sizeof(struct optionlist_s) );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( list == NULL ) return( NULL );
+        spec->optionlist = list;
+        spec->optCap = cap;
+    }
+
+    opt = &spec->optionlist[spec->optnum];
+    memset( opt, 0, sizeof(*opt) );
+    return( opt );
+}
+
+/* the same spec compileSpec builds, from options whose formats were parsed already */
+static int compileTable( superOptSpec_t *spec, const superOptDesc_t *table, int numOpts )
+{
+    struct optionlist_s *opt;
+    const superOptDesc_t *d;
+    int i, j, slots;
+
+    spec->optnum = 0;
+    spec->maxArgs = 1;
+    spec->hashSlot = NULL;
+    spec->hashVal = NULL;
+    freeUsage( spec );
+    sgArenaReset( &spec->arena );
+
+    for( i = 0 ; i < numOpts ; i++ )
+    {
+        d = &table[i];
+        if( d->name == NULL || d->name[0] == '\0' ) return( SG_ERROR_ZERO_LEN_OPTION );
+        if( d->numArgs < 0 || (d->numArgs > 0 && d->types == NULL) || (d->ptrs == NULL && d->bind != SG_BIND_SINK) ) return( SG_ERROR_MISSING_ARG );
+        if( d->varflag && (d->numArgs < 1 || (d->pNumArgs == NULL && d->bind != SG_BIND_SINK)) ) return( SG_ERROR_BAD_FORMAT );
+        if( d->bind == SG_BIND_SINK && (d->sink == NULL || d->numArgs == 0) ) return( SG_ERROR_MISSING_ARG );
+        if( d->bind == SG_BIND_GROW && (d->numArgs == 0 || d->pNumArgs == NULL) ) return( SG_ERROR_MISSING_ARG );
+        if( d->varflag && d->bind != SG_BIND_ARRAY && d->bind != SG_BIND_SINK && d->bind != SG_BIND_GROW )
+        {
+#ifndef __cplusplus
+            return( SG_ERROR_BAD_VARARGTYPE );      /* library built as C */
+#else
+            if( d->bind == SG_BIND_VIEWS && (d->types[0] != STRING || d->numArgs != 1 || __cplusplus < 201703L) ) return( SG_ERROR_BAD_VARARGTYPE );
+            if( d->bind != SG_BIND_VECTOR && d->bind != SG_BIND_VIEWS ) return( SG_ERROR_BAD_VARARGTYPE );
+#endif
+        }
+
+        opt = newOption( spec );
+        if( opt == NULL ) return( SG_ERROR_NO_MEMORY );
+
+        slots = d->numArgs > 0 ? d->numArgs : 1;
+        opt->name = sgArenaStrdup( &spec->arena, d->name );
+        opt->argtype = (int *) sgArenaAlloc( &spec->arena, slots * sizeof(int) );
+        opt->argptr = (PANYTYPE *) sgArenaAlloc( &spec->arena, slots * sizeof(PANYTYPE) );
+        if( opt->name == NULL || opt->argtype == NULL || opt->argptr == NULL ) return( SG_ERROR_NO_MEMORY );
+
+        opt->numargs = d->numArgs;
+        opt->varflag = d->varflag ? 1 : 0;
+        opt->helpString = (char *) d->helpString;
+        opt->bind = d->bind;
+        opt->sink = d->sink;
+        opt->sinkUser = d->sinkUser;
+        for( j = 0 ; j < slots ; j++ )
+        {
+            if( d->bind != SG_BIND_SINK && d->ptrs[j] == NULL ) return( SG_ERROR_MISSING_ARG );
+            if( j < d->numArgs && (d->types[j] < 0 || d->types[j] >= NUMTYPES) ) return( SG_ERROR_BAD_FORMAT_TYPE );
+            opt->argtype[j] = j < d->numArgs ? d->types[j] : INT;
+            opt->argptr[j].c = d->bind != SG_BIND_SINK ? (char *) d->ptrs[j] : NULL;
+        }
+        if( counted( opt ) )
+        {
+            opt->pNumArgs = d->pNumArgs;
+            opt->numArgsMax = d->bind != SG_BIND_ARRAY ? 0 : *d->pNumArgs;   /* 0: no limit */
+        }
+        if( opt->numargs > spec->maxArgs ) spec->maxArgs = opt->numargs;
+        spec->optnum++;
+    }
+
+    return( buildNameIndex( spec ) );
+}
+
+/* one write, so usage doesn't interleave with other threads' output */
+static void printUsage( const superOptSpec_t *spec )
+{
+    size_t len;
+    const char *text = superUsageText( spec, 0, &len );
+
+    if( text == NULL ) return;
+    fwrite( text, 1, len, stderr );
+    fflush( stderr );
+}
+
+static int terminalWidth( void )
+{
+    const char *columns = getenv( "COLUMNS" );
+#ifndef _WIN32
+    struct winsize ws;
+
+    if( ioctl( STDERR_FILENO, TIOCGWINSZ, &ws ) == 0 && ws.ws_col > 0 ) return( ws.ws_col );
+#endif
+    if( columns != NULL && atoi( columns ) > 0 ) return( atoi( columns ) );
+    return( USAGE_WIDTH );
+}
+
+/* usage is rendered twice: once with out NULL to measure, then into a buffer that size */
+static void emit( char *out, size_t *pos, const char *s, size_t n )
+{
+    if( out != NULL ) memcpy( out + *pos, s, n );
+    *pos += n;
+}
+
+static void emitSpaces( char *out, size_t *pos, size_t n )
+{
+    if( out != NULL ) memset( out + *pos, ' ', n );
+    *pos += n;
+}
+
+/* "  -name type type", "  -name type [type, ...]" for a * list, or "  -name (type type) [...]"
+    for a list of tuples. An option that keeps every occurrence adds " [-name ...]" */
+static size_t emitOption( char *out, size_t *pos, const struct optionlist_s *opt )
+{
+    size_t start = *pos;
+    const char *type;
+    int t;
+
+    emit( out, pos, "  ", 2 );
+    emit( out, pos, opt->name, strlen( opt->name ) );
+    if( opt->varflag == 1 && opt->numargs > 1 )
+    {
+        for( t = 0 ; t < opt->numargs ; t++ )
+        {
+            type = typeNames[opt->argtype[t]];
+            emit( out, pos, t == 0 ? " (" : " ", t == 0 ? 2 : 1 );
+            emit( out, pos, type, strlen( type ) );
+        }
+        emit( out, pos, ") [...]", 7 );
+    }
+    else
+    {
+        for( t = 0 ; t < opt->numargs && (t == 0 || opt->varflag != 1) ; t++ )
+        {
+            type = typeNames[opt->argtype[t]];
+            emit( out, pos, " ", 1 );
+            emit( out, pos, type, strlen( type ) );
+            if( opt->varflag == 1 )
+            {
+                emit( out, pos, " [", 2 );
+                emit( out, pos, type, strlen( type ) );
+                emit( out, pos, ", ...]", 6 );
+            }
+        }
+    }
+    if( opt->bind == SG_BIND_GROW )
+    {
+        emit( out, pos, " [", 2 );
+        emit( out, pos, opt->name, strlen( opt->name ) );
+        emit( out, pos, " ...]", 5 );
+    }
+    return( *pos - start );
+}
+
+/* help words filled into the columns from col to width, continuation lines indented to col */
+static void emitHelp( char *out, size_t *pos, const char *help, size_t col, size_t width )
+{
+    size_t lineLen = 0, n;
+
+    while( *help != 0 )
+    {
+        while( *help == ' ' || *help == '\t' || *help == '\n' ) help++;
+        if( *help == 0 ) break;
+        n = strcspn( help, " \t\n" );
+        if( lineLen > 0 && col + lineLen + 1 + n > width )
+        {
+            emit( out, pos, "\n", 1 );
+            emitSpaces( out, pos, col );
+            lineLen = 0;
+        }
+        if( lineLen > 0 )
+        {
+            emit( out, pos, " ", 1 );
+            lineLen++;
+        }
+        emit( out, pos, help, n );
+        lineLen += n;
+        help += n;
+    }
+}
+
+/* options and their types on the left, help aligned in one column on the right. A left side
+    too long for the column puts its help on the next line */
+static size_t renderUsage( const superOptSpec_t *spec, size_t width, char *out )
+{
+    const struct optionlist_s *optionlist = spec->optionlist;
+    size_t pos = 0, col = 0, left;
+    int i;
 
-    n = superParseInternal( argc, argv, usageCall, lastArg, &unAccountedFor, &numUnaccGroups, unaccountedForIndex, ap );
-    
-    va_end( ap );
+    for( i = 0 ; i < spec->optnum ; i++ )
+    {
+        left = emitOption( NULL, &pos, &optionlist[i] ) + 2;
+        if( left > col && (left + USAGE_MIN_HELP <= width || col == 0) ) col = left;
+    }
+    if( col + USAGE_MIN_HELP > width ) col = width > USAGE_MIN_HELP ? width - USAGE_MIN_HELP : 0;
 
-#if (SG_DEBUG > 1)
+    pos = 0;
+    if( spec->optnum > 0 ) emit( out, &pos, "***** Usage *****\n", 18 );
+    for( i = 0 ; i < spec->optnum ; i++ )
     {
-        int i, j;
-        //fprintf(stderr, "n=%d lastErr=%d arc=%d unAcc=%d\n", n,*lastArg,argc,unAccountedFor);
-        for( i = 0 ; i < numUnaccGroups ; i++ )
+        left = emitOption( out, &pos, &optionlist[i] );
+#if SG_ENABLE_HELPSTRING
+        if( optionlist[i].helpString != NULL && optionlist[i].helpString[0] != 0 )
         {
-            for( j = unaccountedForIndex[i].start ; j <= unaccountedForIndex[i].stop ; j++ )
+            if( left + 2 > col )
             {
-                fprintf(stderr, "\t unaccountedFor group[%d] = %d <%s>\n", i, j, argv[j-1]);
+                emit( out, &pos, "\n", 1 );
+                left = 0;
             }
+            emitSpaces( out, &pos, col - left );
+            emitHelp( out, &pos, optionlist[i].helpString, col, width );
         }
-        
-        //if( (unAccountedFor - *lastArg) < argc && argc > MAXOPTS )
-        //    fprintf(stderr, "More extra args than will store.\n");
+#endif
+        emit( out, &pos, "\n", 1 );
     }
+    return( pos );
+}
+
+const char *superUsageText( const superOptSpec_t *spec, int width, size_t *len )
+{
+    superOptSpec_t *cache = (superOptSpec_t *) spec;    /* the rendered text isn't part of the spec proper */
+    struct usageText_s *head, *u;
+    size_t n;
+
+    if( len ) *len = 0;
+    if( spec == NULL ) return( NULL );
+    if( width <= 0 ) width = terminalWidth();
+
+    for( ;; )
+    {
+#if defined(__GNUC__)
+        head = __atomic_load_n( &cache->usage, __ATOMIC_ACQUIRE );
+#else
+        head = cache->usage;
 #endif
-    
-#if SG_GROUP_UNACC_ARGS
-    /* group unaccounted for args */
-    groupUnaccArgs( argc, argv, lastArg, unAccountedFor, numUnaccGroups, unaccountedForIndex, 1 );
+        for( u = head ; u != NULL ; u = u->next )
+        {
+            if( u->width == width )
+            {
+                if( len ) *len = u->len;
+                return( u->text );
+            }
+        }
+
+        /* render outside any lock; if another thread got there first, use its copy */
+        n = renderUsage( spec, (size_t) width, NULL );
+        u = (struct usageText_s *) malloc( sizeof(struct usageText_s) + n );
+        SG_STATS_ADD( allocs, 1 );
+        if( u == NULL ) return( NULL );
+        renderUsage( spec, (size_t) width, u->text );
+        u->text[n] = 0;
+        u->len = n;
+        u->width = width;
+        u->next = head;
+#if defined(__GNUC__)
+        if( __atomic_compare_exchange_n( &cache->usage, &head, u, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ) continue;
+        free( u );
+#else
+        cache->usage = u;
 #endif
-    
-    if( usageCall == 1 && lastArg != NULL && *lastArg == 1 ) n = SG_ERROR_PRINT_USAGE;
-    else if( unAccountedFor && n != SG_ERROR_MISSING_ARG  && n != SG_ERROR_UNKNOWN_ARG)
-    {
-        n = unAccountedFor; // not necessarily an error, just unaccounted for args
     }
-    
-    return(n);
 }
 
-int superParseOpt( int argc, char **argv, int *lastArg, ... )
+static void freeUsage( superOptSpec_t *spec )
 {
-    va_list ap;
-    int n;
-    int usageCall = 0;
-    int unAccountedFor;
-    unaccArgsList_t unaccountedForIndex[MAX_ARG_GRPS];
-    int numUnaccGroups = 0;
-    
-    if( argc == 0 || argv == NULL ) usageCall = 1;
-    
-    va_start( ap, lastArg );
+    struct usageText_s *u, *next;
 
-    n = superParseInternal( argc, argv, usageCall,lastArg, &unAccountedFor, &numUnaccGroups, unaccountedForIndex, ap );
-    
-    va_end( ap );
-    
-#if SG_GROUP_UNACC_ARGS
-    /* group unaccounted for args */
-    groupUnaccArgs( argc, argv, lastArg, unAccountedFor, numUnaccGroups, unaccountedForIndex, 0 );
-#endif
-    
-    if( usageCall == 1 && *lastArg == 1 ) n = SG_ERROR_PRINT_USAGE;
-    else if( unAccountedFor )
+    for( u = spec->usage ; u != NULL ; u = next )
     {
-        n = unAccountedFor; // not necessarily an error, just unaccounted for args
+        next = u->next;
+        free( u );
     }
-        
-    return(n);
+    spec->usage = NULL;
 }
 
-static int superParseInternal( int argc, char **argv, int usageCall, int *lastArg, int *pUnAccountedFor, int *pNumUnaccGroups, unaccArgsList_t *unaccountedForIndex, va_list ap )
+static int parseSpec( superOptCtx_t *ctx, const superOptSpec_t *spec, int argc, char **argv, int usageCall, int *lastArg )
 {
-    char *optstring[MAXOPTS+1] = {0};
-    static int optnum;
+    const struct optionlist_s *optionlist = spec->optionlist;
+    int optnum = spec->optnum;
     int argsleft;
     int i,j;
     int x;
     int good;
     int found = 0;
-    int noName;
-    static struct optionlist_s optionlist[MAXOPTS+1]; //static allows easy re-call for usage printout
-    int return_val;
+    char *attached = NULL;      /* the first value, when written into the option's own arg */
+    char *bundle = NULL;        /* the rest of a bundle of one character options */
+    char *tok;
+    int tokPos, onAttached = 0, fresh;
+    ANYTYPE argval;
     int lastArgProcessed = 0;
     int lastArgProcessedSuccessfully = 0;
-    //int lastFlag = 0;
+    PANYTYPE *argptr;
+    int *pNumArgs = NULL;
+    int *pUnAccountedFor = &ctx->unAccountedFor;
+    int *pNumUnaccGroups = &ctx->numUnaccGroups;
+    superArgSpan_t *unaccountedForIndex = ctx->unaccountedForIndex;
     #ifdef __cplusplus
     bool bIsVector = false;
     #endif
     
     *pUnAccountedFor = 0; // args not associated with detected flags
+    *pNumUnaccGroups = 0;
     
     if( lastArg ) *lastArg = 0;
-    
-    // To do: return correct value (error or last arg processed) in all cases
-    //printf("Orig optnum = %d usageCall=%d\n", optnum,usageCall);
-    return_val = 0;
-    
-    //optnum = 0;
-
-    if( argv == NULL ) argc = 0;
-
-    if( argc != 0 ) optnum = 0;
-
-    // parse all passed-in option formats
-    while( /*usageCall == 0 &&*/ (optstring[optnum] = (char *) va_arg(ap, char *)) != (char *) NULL )
-    { 
-        optionlist[optnum].numargs = parse_string(optstring[optnum],&optionlist[optnum], &noName);
-#if (SG_DEBUG > 3)
-        fprintf(stderr, "Num args to option = %d for <%s>\n",optionlist[optnum].numargs,optstring[optnum]);
-#endif
-        for( i = 0 ; i < optionlist[optnum].numargs ; i++ )
-        {
-#if (SG_DEBUG > 3)
-            fprintf(stderr,"Looping through numargs=%d at iter=%d var=%d\n", optionlist[optnum].numargs, i, optionlist[optnum].varflag);
-#endif
-            if( optionlist[optnum].varflag != 1 )
-            {
-                // this only works for fixed arg formats
-                switch( optionlist[optnum].argtype[i] )
-                {
-                case CHAR: 
-                    optionlist[optnum].argptr[i].c = va_arg(ap, char *);
-                    //printf("Char: type=%d ret=%d val=0x%x\n",optionlist[optnum].argtype[i],good,optionlist[optnum].argptr[i].c);
-                    break;
-                case SHORT: 
-                    optionlist[optnum].argptr[i].h = va_arg(ap, short *);
-                    break;
-                case INT: 
-                    optionlist[optnum].argptr[i].i = va_arg(ap, int *);
-                    break;
-                case UINT:
-                    optionlist[optnum].argptr[i].ui = va_arg(ap, unsigned int *);
-                    break;
-                case HEX:
-                    optionlist[optnum].argptr[i].ui = va_arg(ap, unsigned int *);
-                    break;
-                case LINT:
-                    optionlist[optnum].argptr[i].li = va_arg(ap, long *);
-                    break;
-                case FLOAT: 
-                    optionlist[optnum].argptr[i].f = va_arg(ap, float *);
-                    break;
-                case DOUBLE: 
-                    optionlist[optnum].argptr[i].d = va_arg(ap, double *);
-                    break;
-                case STRING: 
-                    optionlist[optnum].argptr[i].string = va_arg(ap, char **);
-                    break;
-                }
-            }
-            else
-            {
-                // for vararg formats, just get pointer to array and pointer to numArgs.
-                switch( optionlist[optnum].argtype[i] )
-                {
-                case CHAR: 
-                    optionlist[optnum].argptr[i].c = va_arg(ap, char *);
-                    if( optionlist[optnum].argptr[i].c == NULL ) return( SG_ERROR_MISSING_ARG );
-                    //printf("Char: type=%d ret=%d val=0x%x pc=0x%x\n",optionlist[optnum].argtype[i],good,optionlist[optnum].argptr[i].c,pC);
-                    break;
-                case SHORT: 
-                    optionlist[optnum].argptr[i].h = va_arg(ap, short *);
-                    if( optionlist[optnum].argptr[i].h == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case INT: 
-                    optionlist[optnum].argptr[i].i = va_arg(ap, int *);
-                    if( optionlist[optnum].argptr[i].i == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case UINT:
-                    optionlist[optnum].argptr[i].ui = va_arg(ap, unsigned int *);
-                    if( optionlist[optnum].argptr[i].ui == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case HEX:
-                    optionlist[optnum].argptr[i].ui = va_arg(ap, unsigned int *);
-                    if( optionlist[optnum].argptr[i].ui == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case LINT:
-                    optionlist[optnum].argptr[i].li = va_arg(ap, long *);
-                    if( optionlist[optnum].argptr[i].li == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case FLOAT: 
-                    optionlist[optnum].argptr[i].f = va_arg(ap, float *);
-                    //printf("App passed in 0x%x pointer to float array (%d,%d)\n", optionlist[optnum].argptr[i].f,optnum,i);
-                    if( optionlist[optnum].argptr[i].f == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case DOUBLE: 
-                    optionlist[optnum].argptr[i].d = va_arg(ap, double *);
-                    if( optionlist[optnum].argptr[i].d == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                case STRING: 
-                    optionlist[optnum].argptr[i].string = va_arg(ap, char **);
-                    if( optionlist[optnum].argptr[i].string == NULL ) return( SG_ERROR_MISSING_ARG );
-                    break;
-                }
+    SG_STATS_ADD( tokens, usageCall ? 0 : argc );
 
-                // now pop pointer to numArgs
-                optionlist[optnum].pNumArgs = va_arg(ap, int *);
-                optionlist[optnum].numArgsMax = *optionlist[optnum].pNumArgs;
-#if (SG_DEBUG > 3)
-                fprintf(stderr, "Varargs pNumArgs=0x%x %d\n", optionlist[optnum].pNumArgs, *optionlist[optnum].pNumArgs);
-#endif
-                if( optionlist[optnum].pNumArgs == NULL )
-                {
-                    return( SG_ERROR_MISSING_ARG );
-                }
-                else
-                {
-                    *optionlist[optnum].pNumArgs = 0; // initialize
-                }
-            }
-        }
-        
-        // flagless arg (like -help)
-        if(optionlist[optnum].numargs == 0 /*&& usageCall == 0*/)
-        {
-            // need to pop off the 
-            //fprintf(stderr,"flagless arg <%s> optnum=%d optlist_argptr=%d\n", optstring[optnum],optnum,optionlist[optnum].argptr[0].i);
-            optionlist[optnum].argptr[0].i = va_arg(ap, int *);
-            ///////*optionlist[optnum].argptr[0].i = 0; // init
-        }
+    if( ctx->argptrCap < spec->maxArgs )
+    {
+        argptr = (PANYTYPE *) realloc( ctx->argptr, spec->maxArgs * sizeof(PANYTYPE) );
+        SG_STATS_ADD( allocs, 1 );
+        if( argptr == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+        ctx->argptr = argptr;
+        ctx->argptrCap = spec->maxArgs;
+    }
+    argptr = ctx->argptr;
 
-#if SG_ENABLE_HELPSTRING
-        // get help string
-        optionlist[optnum].helpString = va_arg(ap, char *);
-#endif
-        optnum++;
-        //printf("optnum = %d\n", optnum);
-        if( optnum > MAXOPTS )
+    // with an environment prefix, note which options argv gives
+    if( ctx->env.prefix != NULL && !ctx->keepVarCounts )
+    {
+        if( ctx->env.seenCap < optnum )
         {
-#if SG_DEBUG
-            fprintf(stderr, "Too many options in string. More than %d\n",MAXOPTS);
-#endif
-            lastArg = (int *) va_arg(ap, int *);
-            *lastArg = optnum;
-            return( SG_ERROR_TOO_MANY_OPTIONS );
+            unsigned char *seen = (unsigned char *) realloc( ctx->env.seen, optnum );
+            SG_STATS_ADD( allocs, 1 );
+            if( seen == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+            ctx->env.seen = seen;
+            ctx->env.seenCap = optnum;
         }
+        memset( ctx->env.seen, 0, optnum );
     }
 
-
-    // user can tell us to print usage by calling with NULL or argc = 0 or both
-    if( argv == NULL || argc == 0 /*|| usageCall == 1*/ )
+    // var arg counts are per parse
+    for( i = 0 ; i < optnum && !ctx->keepVarCounts ; i++ )
     {
-        argc = 0; // prevent any parsing and just print out 
-        if( optnum > 0 ) fprintf(stderr, "***** Usage *****\n");
-        // print out usage!!!
-        //printf("Help optNum = %d\n", optnum);
-        for( i = 0 ; i < optnum ; i++ )
-        {
-            int t;
-            fprintf(stderr, "\t %s", optionlist[i].name);
-            for( t = 0 ; t < optionlist[i].numargs && t < MAXARGS; t++ )
-            {
-                if( optionlist[i].varflag == 0 )
-                {
-                    fprintf(stderr, " %s", typeNames[optionlist[i].argtype[t]]);
-                }
-                else if( t == 0 ) /* just once */
-                {
-                    fprintf(stderr, " %s [%s, ...]", typeNames[optionlist[i].argtype[t]], typeNames[optionlist[i].argtype[t]]);
-                }
-            }
-#if SG_ENABLE_HELPSTRING
-            if( optionlist[i].helpString != NULL )
-            {
-                fprintf(stderr, " <%s>", optionlist[i].helpString);
-            }
-#endif
-            if( optnum > 0 ) fprintf(stderr, "\n");
-        }
-        
-        return(0);
+        if( counted( &optionlist[i] ) ) *(int *) relocate( ctx, optionlist[i].pNumArgs ) = 0;
     }
     
     argsleft = argc;
@@ -432,88 +1902,154 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /////////////////// now process cmdline argument list  ////////////////////////////////
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    while( argsleft > 0 && usageCall == 0 )
+    while( (argsleft > 0 || bundle != NULL) && usageCall == 0 )
     {
 
-    for( i = 0 /*, lastFlag = 0*/ ; i < optnum && argsleft > 0 ; i++ )
-    {
+        /* the next option of a bundle has no arg of its own: its token was used by the first */
+        fresh = ( bundle == NULL );
+        if( fresh )
+        {
+            i = findOption( ctx, spec, argv[0] );
+            if( i == -1 ) i = attachedOption( ctx, spec, argv[0], &attached, &bundle );
+        }
+        else i = shortOption( spec, bundle, &attached, &bundle );
+
+        if( i == SG_AMBIGUOUS )
+        {
+            *lastArg = argc - argsleft + 1;
+            return( sgCtxSetDiag( ctx, SG_ERROR_AMBIGUOUS_ARG, *lastArg, NULL, -1, argv[0] ) );
+        }
 #if (SG_DEBUG > 2)
-        fprintf(stderr, "Looking for option %d <%s>: argv=<%s> argsleft=%d\n", i, optionlist[i].name,argv[0],argsleft);
+        fprintf(stderr, "Looked up option %d: argv=<%s> argsleft=%d\n", i, argv[0], argsleft);
 #endif
-        found = 0;
-        if( strcmp( argv[0], optionlist[i].name ) == 0 )
+        found = ( i >= 0 );
+        if( found )
         {
-            /* lastFlag = i; */
-            
-            found = 1;
-            argsleft--;    
-            lastArgProcessed++;
-            lastArgProcessedSuccessfully++;        
-            if( argsleft > 0 ) argv++;
+            if( i < ctx->env.seenCap ) ctx->env.seen[i] = 1;
+            if( fresh )
+            {
+                argsleft--;    
+                lastArgProcessed++;
+                lastArgProcessedSuccessfully++;        
+                if( argsleft > 0 ) argv++;
+            }
 #if (SG_DEBUG > 2)
             fprintf(stderr, "Found option <%s>\n", optionlist[i].name);
 #endif
+
+            if( attached != NULL && optionlist[i].numargs == 0 && optionlist[i].varflag != 1 )
+            {
+                *lastArg = argc - argsleft;
+                return( sgCtxSetDiag( ctx, SG_ERROR_INCORRECT_ARG, *lastArg, optionlist[i].name, -1, attached ) );
+            }
+
+            if( optionlist[i].bind == SG_BIND_SINK )
+            {
+                j = sinkValues( ctx, spec, &optionlist[i], argv, argsleft, argc - argsleft + 1, attached, lastArg );
+                attached = NULL;
+                if( j < 0 ) return( j );
+                argv += j;
+                argsleft -= j;
+                lastArgProcessedSuccessfully += j;
+                lastArgProcessed = lastArgProcessedSuccessfully;
+                continue;
+            }
+
+            if( (optionlist[i].varflag == 1 && optionlist[i].numargs > 1) || optionlist[i].bind == SG_BIND_GROW )
+            {
+                j = tupleValues( ctx, spec, &optionlist[i], argv, argsleft, argc - argsleft + 1, attached, lastArg );
+                attached = NULL;
+                if( j < 0 ) return( j );
+                argv += j;
+                argsleft -= j;
+                lastArgProcessedSuccessfully += j;
+                lastArgProcessed = lastArgProcessedSuccessfully;
+                continue;
+            }
+
+            /* where this option's values go; moved into the record being parsed for a batch */
+            for( j = 0 ; j < optionlist[i].numargs || j == 0 ; j++ )
+            {
+                argptr[j].c = (char *) relocate( ctx, optionlist[i].argptr[j].c );
+            }
+            pNumArgs = (int *) relocate( ctx, optionlist[i].pNumArgs );
             
             if( optionlist[i].numargs == 0 )
             {
                 // handle flagless arg like -help
-                *optionlist[i].argptr[0].i = 1;
+                *argptr[0].i = 1;
             }
             
-            for( j = 0 ; (j < optionlist[i].numargs && optionlist[i].varflag != 1 && argsleft > 0 ) || (optionlist[i].varflag == 1 && argsleft > 0) ; j++, argsleft--, argv++ )
+#ifdef __cplusplus
+            /* a vector grows once: by the values up to the next option name */
+            if( optionlist[i].varflag == 1 && (optionlist[i].bind == SG_BIND_VECTOR || optionlist[i].bind == SG_BIND_VIEWS) && (argsleft > 0 || attached != NULL) )
             {
+                reserveVector( &argptr[0], optionlist[i].argtype[0], optionlist[i].bind, countValues( ctx, spec, argv, argsleft ) + (attached != NULL) );
+            }
+#endif
+            /* values come from the args that follow, after the attached one if there is one */
+            for( j = 0 ; (j < optionlist[i].numargs && optionlist[i].varflag != 1 && (argsleft > 0 || attached != NULL)) || (optionlist[i].varflag == 1 && (argsleft > 0 || attached != NULL)) ;
+                 j++, attached = NULL, argsleft -= !onAttached, argv += !onAttached )
+            {
+                onAttached = ( attached != NULL );
+                tok = onAttached ? attached : argv[0];
+                tokPos = onAttached ? argc - argsleft : argc - argsleft + 1;
                 if( optionlist[i].varflag != 1 )
                 {
                     lastArgProcessed=lastArgProcessedSuccessfully+1; /*lastArgProcessed++; */
-                    optionlist[i].argval[j] = getval(argv[0], optionlist[i].argtype[j], &good);
+                    argval = convertValue(tok, optionlist[i].argtype[j], &good);
                     switch( optionlist[i].argtype[j] )
                     {
                         case CHAR: 
-                            *optionlist[i].argptr[j].c = optionlist[i].argval[j].c;
-                            //printf("got char: %c\n",optionlist[i].argval[j].c);
+                            *argptr[j].c = argval.c;
+                            //printf("got char: %c\n",argval.c);
                             break;
                         case SHORT: 
-                            *optionlist[i].argptr[j].h = optionlist[i].argval[j].h;
+                            *argptr[j].h = argval.h;
                             break;
                         case INT: 
-                            *optionlist[i].argptr[j].i = optionlist[i].argval[j].i;
+                            *argptr[j].i = argval.i;
                             break;
                         case UINT:
-                            *optionlist[i].argptr[j].ui = optionlist[i].argval[j].ui;
+                            *argptr[j].ui = argval.ui;
                             break;
                         case HEX:
-                            //printf("got hex: %x good=%d\n",optionlist[i].argval[j].ui,good);
-                            *optionlist[i].argptr[j].ui = optionlist[i].argval[j].ui;
+                            //printf("got hex: %x good=%d\n",argval.ui,good);
+                            *argptr[j].ui = argval.ui;
                             break;
                         case LINT:
-                            //printf("got long: %x good=%d\n",optionlist[i].argval[j].ui,good);
-                            *optionlist[i].argptr[j].li = optionlist[i].argval[j].li;
+                            //printf("got long: %x good=%d\n",argval.ui,good);
+                            *argptr[j].li = argval.li;
                             break;
                         case FLOAT: 
-                            *optionlist[i].argptr[j].f = optionlist[i].argval[j].f;
+                            *argptr[j].f = argval.f;
                             break;
                         case DOUBLE: 
-                            *optionlist[i].argptr[j].d = optionlist[i].argval[j].d;
+                            *argptr[j].d = argval.d;
+                            break;
+                        case SIZE:
+                            *argptr[j].ull = argval.ull;
+                            break;
+                        case DURATION:
+                            *argptr[j].ll = argval.ll;
                             break;
                         case STRING: 
-                            //printf("For string, argval=0x%x argv=0x%x\n", optionlist[i].argval[j].string,argv[0]);
-                            *optionlist[i].argptr[j].string = optionlist[i].argval[j].string;
-/*                             if( check_if_option(argv[0], optionlist, optnum) >= 0 && optionlist[i].varflag == 1 ) */
+                            //printf("For string, argval=0x%x argv=0x%x\n", argval.string,argv[0]);
+                            *argptr[j].string = keepString( ctx, argval.string );
+                            if( *argptr[j].string == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, tokPos, optionlist[i].name, -1, NULL ) );
+/*                             if( check_if_option(argv[0], spec) >= 0 && optionlist[i].varflag == 1 ) */
 /*                                 good = -1; */
                             break;
                         default: 
-#if SG_DEBUG
-                            fprintf(stderr, "Bad argtype %d\n",optionlist[i].argtype[j]); 
-#endif
                             //*lastArg = lastArgProcessed;
                             *lastArg = lastArgProcessedSuccessfully;
-                            return( SG_ERROR_BAD_ARGTYPE );
+                            return( sgCtxSetDiag( ctx, SG_ERROR_BAD_ARGTYPE, tokPos, optionlist[i].name, -1, tok ) );
                     }
                     
                     if( good == 0 )
                     {
                         //lastArgProcessed = argc - argsleft + 1;
-                        lastArgProcessedSuccessfully = argc - argsleft + 1;    
+                        lastArgProcessedSuccessfully = tokPos;    
                         
 #if (SG_DEBUG > 1)                        
                         fprintf(stderr, "good read: lastArgProc=%d lastSuccess=%d\n",lastArgProcessed, lastArgProcessedSuccessfully);
@@ -521,42 +2057,25 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
                     }
                     else if( good == -1 )
                     {
-                        x = check_if_option(argv[0], optionlist, optnum);
-                        if( x < 0 )
-                        {
-#if SG_DEBUG
-                            fprintf(stderr,"User did not supply correct arguments to option name <%s>\n",optionlist[i].name);
-#endif
-                            //*lastArg = lastArgProcessed;
-                            *lastArg = lastArgProcessedSuccessfully;
-                            return(SG_ERROR_INCORRECT_ARG);
-                        }
-                        else 
-                        {
-#if SG_DEBUG
-                            fprintf(stderr,"[1] User did not supply enough arguments to option name <%s>\n",optionlist[i].name);
-#endif
-                            //*lastArg = lastArgProcessed;
-                            *lastArg = lastArgProcessedSuccessfully;
-                            return( SG_ERROR_MISSING_ARG );
-                        }
+                        x = onAttached ? -1 : check_if_option(ctx, tok, spec);
+                        //*lastArg = lastArgProcessed;
+                        *lastArg = lastArgProcessedSuccessfully;
+                        /* the next option where a value should be means one is missing */
+                        return( sgCtxSetDiag( ctx, x < 0 ? SG_ERROR_INCORRECT_ARG : SG_ERROR_MISSING_ARG, tokPos,
+                            optionlist[i].name, optionlist[i].argtype[j], tok ) );
                     }
                 }
                 else        /* var arg list */
                 {
 #ifdef __cplusplus
-                    if (optionlist[i].numArgsMax == 0) {
-                        bIsVector = true;
-                    } else {
-                        bIsVector = false;
-                    }
+                    bIsVector = optionlist[i].bind == SG_BIND_VECTOR || optionlist[i].bind == SG_BIND_VIEWS;
 #endif
 
                     if( j >= optionlist[i].numArgsMax && optionlist[i].numArgsMax > 0) 
                     {
-#if SG_DEBUG
-                        fprintf(stderr, "Warning: too many commandline args supplied for option <%s>. Max=%d\n",optionlist[i].name,optionlist[i].numArgsMax);
-#endif
+                        /* the array is full: skip values, but the list still ends at the next option */
+                        if( check_if_option(ctx, tok, spec) >= 0 ) break;
+                        dropValue( ctx, optionlist[i].name );
                         continue;
                     }
 
@@ -565,111 +2084,127 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
                     switch( optionlist[i].argtype[0] )
                     {
                         case CHAR: 
+                            argval.c = myread_char(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                optionlist[i].argptr[0].vc->push_back(myread_char(argv[0],&good));
+                                if (good == 0) argptr[0].vc->push_back(argval.c);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].c[j] = myread_char(argv[0],&good); 
+                            if (good == 0) {
+                                argptr[0].c[j] = argval.c; 
                             }
                             break;
                         case SHORT: 
+                            argval.h = myread_short(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                myread_short(argv[0],&good);
-                                if (good == 0) {
-                                    optionlist[i].argptr[0].vh->push_back(myread_short(argv[0],&good));
-                                }
+                                if (good == 0) argptr[0].vh->push_back(argval.h);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].h[j] = myread_short(argv[0],&good); 
+                            if (good == 0) {
+                                argptr[0].h[j] = argval.h; 
                             }
                             break;
                         case INT: 
+                            argval.i = myread_int(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                myread_int(argv[0],&good);
-                                if (good == 0) {
-                                    optionlist[i].argptr[0].vi->push_back(myread_int(argv[0],&good));
-                                }
+                                if (good == 0) argptr[0].vi->push_back(argval.i);
                             } 
                             else 
 #endif
-                            {
-                                printf("not a vector %d\n", myread_int(argv[0],&good));
-                                optionlist[i].argptr[0].i[j] = myread_int(argv[0],&good);
+                            if (good == 0) {
+                                argptr[0].i[j] = argval.i;
                             }
                             break;
                         case UINT:
+                            argval.ui = myread_uint(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                               myread_uint(argv[0],&good);
-                                if (good == 0) {
-                                    optionlist[i].argptr[0].vui->push_back(myread_uint(argv[0],&good));
-                                }
+                                if (good == 0) argptr[0].vui->push_back(argval.ui);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].ui[j] = myread_uint(argv[0],&good);
+                            if (good == 0) {
+                                argptr[0].ui[j] = argval.ui;
                             }
                             break;
                         case HEX:
+                            argval.ui = myread_hex(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                myread_hex(argv[0],&good);
-                                if (good == 0) {
-                                    optionlist[i].argptr[0].vui->push_back(myread_hex(argv[0],&good));
-                                }
+                                if (good == 0) argptr[0].vui->push_back(argval.ui);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].ui[j] = myread_hex(argv[0],&good);
+                            if (good == 0) {
+                                argptr[0].ui[j] = argval.ui;
                             }
                             break;
                         case LINT:
+                            argval.li = myread_lint(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                myread_lint(argv[0],&good);
-                                if (good == 0) {
-                                    optionlist[i].argptr[0].vli->push_back(myread_lint(argv[0],&good));
-                                }
+                                if (good == 0) argptr[0].vli->push_back(argval.li);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].li[j] = myread_lint(argv[0],&good);
+                            if (good == 0) {
+                                argptr[0].li[j] = argval.li;
                             }
                             break;
                         case FLOAT:
+                            argval.f = myread_float(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                optionlist[i].argptr[0].vf->push_back(myread_float(argv[0],&good));
+                                if (good == 0) argptr[0].vf->push_back(argval.f);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].f[j] = myread_float(argv[0],&good);
+                            if (good == 0) {
+                                argptr[0].f[j] = argval.f;
                             }
                             break;
                         case DOUBLE: 
+                            argval.d = myread_double(tok,&good);
 #ifdef __cplusplus
                             if (bIsVector) {
-                                optionlist[i].argptr[0].vd->push_back(myread_double(argv[0],&good));
+                                if (good == 0) argptr[0].vd->push_back(argval.d);
                             } 
                             else 
 #endif
-                            {
-                                optionlist[i].argptr[0].d[j] = myread_double(argv[0],&good);
+                            if (good == 0) {
+                                argptr[0].d[j] = argval.d;
+                            }
+                            break;
+                        case SIZE:
+                            argval.ull = myread_size(tok,&good);
+#ifdef __cplusplus
+                            if (bIsVector) {
+                                if (good == 0) argptr[0].vull->push_back(argval.ull);
+                            } 
+                            else 
+#endif
+                            if (good == 0) {
+                                argptr[0].ull[j] = argval.ull;
+                            }
+                            break;
+                        case DURATION:
+                            argval.ll = myread_duration(tok,&good);
+#ifdef __cplusplus
+                            if (bIsVector) {
+                                if (good == 0) argptr[0].vll->push_back(argval.ll);
+                            } 
+                            else 
+#endif
+                            if (good == 0) {
+                                argptr[0].ll[j] = argval.ll;
                             }
                             break;
                         case STRING: 
-                            x = check_if_option(argv[0], optionlist, optnum);
+                            x = onAttached ? -1 : check_if_option(ctx, tok, spec);
                             if( x >= 0 ) /* end of var list */
                             {
                                 good = -2;
@@ -678,15 +2213,22 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
                             {    
                                 good = 0;
 #ifdef __cplusplus
+#if __cplusplus >= 201703L
+                                if (optionlist[i].bind == SG_BIND_VIEWS) {
+                                    argptr[0].vsv->push_back(std::string_view(keepString( ctx, tok )));
+                                }
+                                else
+#endif
                                 if (bIsVector) {
-                                    optionlist[i].argptr[0].vcp->push_back(argv[0]);
+                                    argptr[0].vcp->push_back(keepString( ctx, tok ));
                                 } 
                                 else 
 #endif
                                 {
                                     if( j < optionlist[i].numArgsMax && optionlist[i].numArgsMax > 0)
                                     {
-                                        optionlist[i].argptr[0].string[j] = argv[0]; 
+                                        argptr[0].string[j] = keepString( ctx, tok );
+                                        if( argptr[0].string[j] == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, tokPos, optionlist[i].name, -1, NULL ) );
                                     }
                                     else
                                     {
@@ -696,19 +2238,16 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
                             } 
                                 break;
                         default: 
-#if SG_DEBUG
-                            fprintf(stderr, "Bad varargtype %d\n",optionlist[i].argtype[j]); 
-#endif
                             //*lastArg = lastArgProcessed;
                             *lastArg = lastArgProcessedSuccessfully;
-                            return( SG_ERROR_BAD_VARARGTYPE );
+                            return( sgCtxSetDiag( ctx, SG_ERROR_BAD_VARARGTYPE, tokPos, optionlist[i].name, -1, tok ) );
                     }
                     
                     if( good == 0 ) // good read
                     {
-                        *optionlist[i].pNumArgs = j+1;
+                        *pNumArgs = j+1;
                         //lastArgProcessed = argc - argsleft + 1;
-                        lastArgProcessedSuccessfully = argc - argsleft + 1;    
+                        lastArgProcessedSuccessfully = tokPos;    
 #if (SG_DEBUG > 1)                        
                         printf("2 good read: lastArg=%d lastSuccess=%d\n",lastArgProcessed, lastArgProcessedSuccessfully);
 #endif
@@ -716,61 +2255,37 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
                     
                     if( good == -1 )    /* bad data type */
                     {
-                        x = check_if_option(argv[0], optionlist, optnum);
+                        x = onAttached ? -1 : check_if_option(ctx, tok, spec);
                         if( x < 0 )
                         {
-#if SG_DEBUG
-                            fprintf(stderr, "Var arg list bad data type for option <%s>\n",optionlist[i].name);
-#endif
                             //*lastArg = lastArgProcessed;
                             *lastArg = lastArgProcessedSuccessfully+1;
-                            return( SG_ERROR_INCORRECT_ARG );
+                            return( sgCtxSetDiag( ctx, SG_ERROR_INCORRECT_ARG, tokPos, optionlist[i].name, optionlist[i].argtype[0], tok ) );
                         }
                         else    /* next option detected -- end of var list -- move 1 arg back */
                         {
-                            optionlist[i].numargs = j;
                             break;        /* get out of numargs loop and call function */
                         }
                     }
                     else if( good == -2 )    /* detected end of var list -- move 1 arg back */
                     {
                         /* Var arg string list terminates at next option */
-                        optionlist[i].numargs = j;
                         break;        /* get out of numargs loop and call function */
                     }
                     else if( good == -3 ) // too many args
                     {
-#if SG_DEBUG
-                        fprintf(stderr, "Warning: too many commandline args supplied for option <%s>. Max=%d\n",optionlist[i].name,optionlist[i].numArgsMax);
-#endif
-                    }
-                    else if( argsleft == 1 )    /* end of command line ends var arg list */
-                    {
-                        optionlist[i].numargs = j+1;
+                        dropValue( ctx, optionlist[i].name );
                     }
                 }
             }
 
             if( j != optionlist[i].numargs && optionlist[i].varflag != 1 )
             {
-#if SG_DEBUG
-                fprintf(stderr,"[2] User did not supply enough arguments to option name <%s> Expected %d Got %d\n",optionlist[i].name,optionlist[i].numargs,j);
-#endif
                 //*lastArg = lastArgProcessed;
                 *lastArg = lastArgProcessedSuccessfully+1;
-                return( SG_ERROR_MISSING_ARG );
+                return( sgCtxSetDiag( ctx, SG_ERROR_MISSING_ARG, argc + 1, optionlist[i].name, optionlist[i].argtype[j], NULL ) );
             }
-            i = -1;  /* experimental bug fix? */
-        }
-        else
-        {
-            found = 0;
-            //*lastArg = lastArgProcessedSuccessfully+1;
-#if (SG_DEBUG > 2)
-            printf("last successful arg = %d lastArg=%d processed=%d\n",lastArgProcessedSuccessfully, *lastArg,lastArgProcessed);
-#endif
         }
-    }
 
     if( found == 0 )
     {
@@ -780,52 +2295,224 @@ static int superParseInternal( int argc, char **argv, int usageCall, int *lastAr
 #endif
         if( argv[0][0] == '-' || argv[0][0] == '+' || argv[0][0] == '=' )
         {
-#if (SG_DEBUG > 0)
-            fprintf(stderr,"unknown option at argv=%s left=%d lastProc=%d lastProcSuc=%d\n",argv[0],argsleft,lastArgProcessed,lastArgProcessedSuccessfully);
-            //fprintf(stderr,"User did not supply option name <%s>\n",optionlist[lastFlag].name);
-#endif
-            return(SG_ERROR_UNKNOWN_ARG);
+            return( sgCtxSetDiag( ctx, SG_ERROR_UNKNOWN_ARG, argc - argsleft + 1, NULL, -1, argv[0] ) );
         }
         
         lastArgProcessed++;
         *lastArg = lastArgProcessedSuccessfully+1;
         
-        if( *pNumUnaccGroups < MAX_ARG_GRPS )
+        /* lastArgProcessed doesn't count earlier extras: the span needs the real position */
+        if( *pNumUnaccGroups == 0 || argc - argsleft + 1 != unaccountedForIndex[(*pNumUnaccGroups)-1].start + unaccountedForIndex[(*pNumUnaccGroups)-1].count )
         {
-            if( *pNumUnaccGroups == 0 || (lastArgProcessed - unaccountedForIndex[(*pNumUnaccGroups)-1].stop) != 1 )
+            if( *pNumUnaccGroups == ctx->unaccGroupsCap )
             {
-                (*pNumUnaccGroups)++;
-                unaccountedForIndex[(*pNumUnaccGroups)-1].start = lastArgProcessed;
-                unaccountedForIndex[(*pNumUnaccGroups)-1].stop = lastArgProcessed;
+                int cap = ctx->unaccGroupsCap ? 2 * ctx->unaccGroupsCap : FIRST_GRPS;
+                superArgSpan_t *list = (superArgSpan_t *) realloc( ctx->unaccountedForIndex, cap * sizeof(superArgSpan_t) );
+                SG_STATS_ADD( allocs, 1 );
+
+                if( list == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+                ctx->unaccountedForIndex = unaccountedForIndex = list;
+                ctx->unaccGroupsCap = cap;
             }
-            else
+            (*pNumUnaccGroups)++;
+            unaccountedForIndex[(*pNumUnaccGroups)-1].start = argc - argsleft + 1;
+            unaccountedForIndex[(*pNumUnaccGroups)-1].count = 1;
+        }
+        else
+        {
+            unaccountedForIndex[(*pNumUnaccGroups)-1].count++;
+        }
+    
+        (*pUnAccountedFor)++;
+#if (SG_DEBUG > 1)
+        fprintf(stderr, "unaccounted for argument count = %d lastArgProc=%d lastSuccess=%d lastArg=%d NumUnaccGroups=%d start=%d count=%d\n", *pUnAccountedFor, lastArgProcessed, lastArgProcessedSuccessfully, *lastArg,*pNumUnaccGroups,unaccountedForIndex[(*pNumUnaccGroups)-1].start,unaccountedForIndex[(*pNumUnaccGroups)-1].count);
+#endif
+        if( argsleft > 0 ) argv++;
+        argsleft--;
+    }
+    
+    }
+
+    //*lastArg = lastArgProcessedSuccessfully;
+    
+    return( 0 );
+}
+
+
+/* hand one occurrence's values to its sink as they convert, then say it's complete.
+    argv[0] is the first value, at position pos, unless the option came with its first value
+    attached (then at pos - 1). Returns how many args of argv were used, or an error */
+static int sinkValues( superOptCtx_t *ctx, const superOptSpec_t *spec, const struct optionlist_s *opt, char **argv, int argsleft, int pos, char *attached, int *lastArg )
+{
+    superSinkEvent_t ev;
+    ANYTYPE value;
+    char *tok;
+    int k, good, n;
+    int base = attached ? pos - 1 : pos;    /* value k is at position base + k */
+
+    if( attached ) argsleft++;
+
+    ev.name = opt->name;
+    for( k = 0 ; opt->varflag == 1 || k < opt->numargs ; k++ )
+    {
+        /* a list of tuples goes through its fields in turn */
+        ev.type = opt->argtype[opt->varflag == 1 ? k % opt->numargs : k];
+        if( k >= argsleft )
+        {
+            if( opt->varflag == 1 && k % opt->numargs == 0 ) break;
+            *lastArg = base + k - 1;
+            return( sgCtxSetDiag( ctx, SG_ERROR_MISSING_ARG, base + k, opt->name, ev.type, NULL ) );
+        }
+        tok = attached ? (k == 0 ? attached : argv[k-1]) : argv[k];
+
+        /* a var list ends at the next option name, but not inside a tuple; an attached value is always a value */
+        value = convertValue( tok, ev.type, &good );
+        if( opt->varflag == 1 && (ev.type == STRING || good != 0) && tok != attached && check_if_option( ctx, tok, spec ) >= 0 )
+        {
+            if( k % opt->numargs == 0 ) break;
+            *lastArg = base + k - 1;
+            return( sgCtxSetDiag( ctx, SG_ERROR_MISSING_ARG, base + k, opt->name, ev.type, tok ) );
+        }
+        if( good != 0 )
+        {
+            *lastArg = base + k;
+            return( sgCtxSetDiag( ctx, SG_ERROR_INCORRECT_ARG, base + k, opt->name, ev.type, tok ) );
+        }
+        if( ev.type == STRING )
+        {
+            value.string = keepString( ctx, tok );
+            if( value.string == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, base + k, opt->name, -1, NULL ) );
+        }
+
+        ev.index = k;
+        ev.value = &value;
+        ev.count = 0;
+        if( (n = opt->sink( opt->sinkUser, &ev )) < 0 )
+        {
+            *lastArg = base + k;
+            return( sgCtxSetDiag( ctx, n, base + k, opt->name, ev.type, tok ) );
+        }
+    }
+
+    ev.index = k;
+    ev.value = NULL;
+    ev.count = k;
+    if( (n = opt->sink( opt->sinkUser, &ev )) < 0 )
+    {
+        *lastArg = pos - 1;
+        return( sgCtxSetDiag( ctx, n, pos - 1, opt->name, -1, NULL ) );
+    }
+    return( attached && k > 0 ? k - 1 : k );
+}
+
+/* a list of tuples: whole tuples up to the next option name, each field into its own column
+    at the tuple's index (or appended to its std::vector). An SG_BIND_GROW option appends to its
+    grown columns instead, after the earlier occurrences' values: a list tuple by tuple, a fixed
+    option its one tuple. Returns the args used, like sinkValues */
+static int tupleValues( superOptCtx_t *ctx, const superOptSpec_t *spec, const struct optionlist_s *opt, char **argv, int argsleft, int pos, char *attached, int *lastArg )
+{
+    ANYTYPE value;
+    PANYTYPE col;
+    char *tok;
+    int *pNumArgs = (int *) relocate( ctx, opt->pNumArgs );
+    int base = attached ? pos - 1 : pos;    /* value k is at position base + k */
+    int grow = ( opt->bind == SG_BIND_GROW );
+    int vector = 0, full = 0, k, f = 0, good, n = grow ? *pNumArgs : 0, err = 0;
+    size_t size;
+
+    if( attached ) argsleft++;
+#ifdef __cplusplus
+    vector = ( opt->bind == SG_BIND_VECTOR );
+    for( f = 0 ; vector && f < opt->numargs ; f++ )
+    {
+        col.c = (char *) relocate( ctx, opt->argptr[f].c );
+        reserveVector( &col, opt->argtype[f], opt->bind, (countValues( ctx, spec, argv, argsleft - (attached != NULL) ) + (attached != NULL)) / opt->numargs );
+    }
+#endif
+
+    for( k = 0 ; k < argsleft && (opt->varflag == 1 || k < opt->numargs) ; k++ )
+    {
+        f = k % opt->numargs;
+        tok = attached ? (k == 0 ? attached : argv[k-1]) : argv[k];
+
+        /* the columns are full: skip values, but the list still ends at the next option */
+        full = full || ( !vector && !grow && f == 0 && n >= opt->numArgsMax );
+        if( full )
+        {
+            if( tok != attached && check_if_option( ctx, tok, spec ) >= 0 ) break;
+            dropValue( ctx, opt->name );
+            continue;
+        }
+
+        /* a fixed option's %s takes whatever comes next, like any fixed value */
+        value = convertValue( tok, opt->argtype[f], &good );
+        if( ((opt->argtype[f] == STRING && opt->varflag == 1) || good != 0) && tok != attached && check_if_option( ctx, tok, spec ) >= 0 )
+        {
+            if( f == 0 && opt->varflag == 1 ) break;
+            *lastArg = base + k - 1;
+            err = sgCtxSetDiag( ctx, SG_ERROR_MISSING_ARG, base + k, opt->name, opt->argtype[f], tok );
+            break;
+        }
+        if( good != 0 )
+        {
+            *lastArg = base + k;
+            err = sgCtxSetDiag( ctx, SG_ERROR_INCORRECT_ARG, base + k, opt->name, opt->argtype[f], tok );
+            break;
+        }
+        if( opt->argtype[f] == STRING && (value.string = keepString( ctx, tok )) == NULL )
+        {
+            err = sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, base + k, opt->name, -1, NULL );
+            break;
+        }
+
+        col.c = (char *) relocate( ctx, opt->argptr[f].c );
+        size = opt->argtype[f] == STRING ? sizeof(char *) : typeSize( opt->argtype[f] );
+        if( grow )
+        {
+            if( (err = growColumn( ctx, col.string, size, n )) != 0 )
             {
-                unaccountedForIndex[(*pNumUnaccGroups)-1].stop = lastArgProcessed;
+                *lastArg = base + k;
+                err = sgCtxSetDiag( ctx, err, base + k, opt->name, -1, NULL );
+                break;
             }
-            
-            (*pUnAccountedFor)++;
+            col.c = *col.string;
         }
-#if (SG_DEBUG > 1)
-        fprintf(stderr, "unaccounted for argument count = %d lastArgProc=%d lastSuccess=%d lastArg=%d NumUnaccGroups=%d start=%d stop=%d\n", *pUnAccountedFor, lastArgProcessed, lastArgProcessedSuccessfully, *lastArg,*pNumUnaccGroups,unaccountedForIndex[(*pNumUnaccGroups)-1].start,unaccountedForIndex[(*pNumUnaccGroups)-1].stop);
+#ifdef __cplusplus
+        if( vector ) editColumn( col, opt->argtype[f], &value );
+        else
 #endif
-        if( argsleft > 0 ) argv++;
-        argsleft--;
-    }
-    
+        if( opt->argtype[f] == STRING ) col.string[n] = value.string;
+        else memcpy( col.c + n * size, &value, size );
+
+        if( f == opt->numargs - 1 ) *pNumArgs = ++n;
     }
 
-    //*lastArg = lastArgProcessedSuccessfully;
-    //return_val = lastArgProcessed;
-    
-    return( return_val );
+    /* a tuple cut short by the end of the args */
+    f = k % opt->numargs;
+    if( err == 0 && !full && (f != 0 || (opt->varflag != 1 && k < opt->numargs)) )
+    {
+        *lastArg = base + k - 1;
+        err = sgCtxSetDiag( ctx, SG_ERROR_MISSING_ARG, base + k, opt->name, opt->argtype[f], NULL );
+    }
+#ifdef __cplusplus
+    /* the columns of a vector list stay the same length: drop the fields of a partial tuple */
+    while( err != 0 && vector && f-- > 0 )
+    {
+        col.c = (char *) relocate( ctx, opt->argptr[f].c );
+        editColumn( col, opt->argtype[f], NULL );
+    }
+#endif
+    if( err != 0 ) return( err );
+    return( attached && k > 0 ? k - 1 : k );
 }
 
-
-static int parse_string(char *s, struct optionlist_s *option, int *noName)
+static int parse_string(char *s, struct optionlist_s *option, int *noName, sgArena_t *arena)
 {
     size_t len;
     int z;
     int offset = 0;
+    int tuple = 0;
+    int nameLen, numConvs;
     char *pN, *pM;
 
     if (s == NULL) return(0);
@@ -839,9 +2526,6 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
 
     if( len < 2 )
     {
-#if SG_DEBUG
-        fprintf(stderr, "Parse_string: option has zero length <%s> len=%d\n", s, (int) len);
-#endif
         return(SG_ERROR_ZERO_LEN_OPTION);
     }
 
@@ -853,6 +2537,12 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
         option->varflag = 1;
         offset = 1;
         //printf("var found\n");
+        if( pM[1] == '(' )  /* a list of tuples: *( ... ) */
+        {
+            if( pN != pM + 2 || strchr( pN, ')' ) == NULL ) return( SG_ERROR_BAD_FORMAT );
+            offset = 2;
+            tuple = 1;
+        }
     }
     else if( pN != NULL )    /* explicit list implied */
     {
@@ -862,11 +2552,29 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
     else
     {
     }
+    if( pN != NULL && pN - offset > s + 1 && pN[-1 - offset] == '+' )  /* every occurrence is kept */
+    {
+        option->bind = SG_BIND_GROW;
+        offset++;
+    }
+    if( pN != NULL && pN - offset > s + 1 && pN[-1 - offset] == '>' )  /* values go to a sink */
+    {
+        if( option->bind == SG_BIND_GROW ) return( SG_ERROR_BAD_FORMAT );
+        option->bind = SG_BIND_SINK;
+        offset++;
+    }
     
     if( pN != NULL )
     {
-        strncpy(option->name, s, pN-s);
-        option->name[strlen(s)-strlen(pN)-1-offset] = '\0';
+        /* the name, less the space (and the '*', '(', '>' or '+') before the first '%' */
+        nameLen = (int) (pN-s) - 1 - offset;
+        if( nameLen < 0 ) nameLen = 0;
+        option->name = (char *) sgArenaAlloc( arena, nameLen + 1 );
+        for( numConvs = 0, pM = pN ; pM != NULL ; pM = strchr( pM + 1, '%' ) ) numConvs++;
+        option->argtype = (int *) sgArenaAlloc( arena, numConvs * sizeof(int) );
+        if( option->name == NULL || option->argtype == NULL ) return( SG_ERROR_NO_MEMORY );
+        memcpy( option->name, s, nameLen );
+        option->name[nameLen] = '\0';
 
         if( pN == s )        /* no name ==> wildcard */
             *noName = 1;
@@ -875,9 +2583,6 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
 
         if( pN-s >= (int)len - 1 )
         {
-#if SG_DEBUG
-            fprintf(stderr, "Parse_String: No formats given in <%s>\n",s /* was scopy */);
-#endif
             return(SG_ERROR_NO_FORMATS);
         }
         else
@@ -890,16 +2595,14 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
             {
                 if( (z = parse_format( pN, option->argtype )) == 0 )
                 {
-#if SG_DEBUG
-                    fprintf(stderr,"var arg option but no valid var arg list\n");
-#endif
                     return(0);  /* newly added 9-27-92. bug if gave vararg option but no list */
                 }
                 else if( z < 0 )
                 {
-#if SG_DEBUG
-                    fprintf(stderr,"Incorrect var arg list\n");
-#endif
+                    return(SG_ERROR_MIXED_TYPES_IN_VAR);
+                }
+                else if( z > 1 && !tuple )
+                {
                     return(SG_ERROR_MIXED_TYPES_IN_VAR);
                 }
                 
@@ -914,7 +2617,9 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
         
         option->varflag = 0;
         *noName = 0;
-        strcpy( option->name, s );
+        option->name = sgArenaStrdup( arena, s );
+        option->argtype = NULL;
+        if( option->name == NULL ) return( SG_ERROR_NO_MEMORY );
         return( 0 );
     }
 
@@ -922,86 +2627,45 @@ static int parse_string(char *s, struct optionlist_s *option, int *noName)
 
 static int parse_format(char *s, int *argtypes)
 {
-    char *scopy, *sp, string[MAXSTRING];
-    int len;
-    int i, numargs;
-    static char *arg[MAXARGS];
-    
-    //printf("parse_format: s = <%s>\n", s);
+    static const struct { const char *conv; int type; } convs[] =
+    {
+        /* two letter conversions first so %lf is not taken for %l... */
+        { "lf", DOUBLE }, { "hd", SHORT }, { "ld", LINT },
+        { "f", FLOAT }, { "c", CHAR }, { "d", INT }, { "s", STRING }, { "u", UINT }, { "x", HEX },
+        { "B", SIZE }, { "T", DURATION }
+    };
+    char *sp;
+    int k, numargs;
     
-    sp = strstr(s,"%");    
+    sp = strchr(s,'%');    
     if( sp == NULL )
     {
-#if SG_DEBUG
-        fprintf(stderr, "Bad format in <%s>. No %% sign.\n", s);
-#endif
         return(SG_ERROR_BAD_FORMAT);
     }
 
-    len = (int) strlen( sp );
-    scopy = (char *) malloc( len + 1 );
-    strcpy( scopy, sp );
-    //scopy = (char *) strdup( sp ); // eliminate strdup call
-
-    for( numargs = 0, arg[numargs] = strtok(scopy, "%");
-        (arg[++numargs] = strtok( (char *) NULL, "%")) != NULL && numargs < MAXARGS-1; )
-    {
-        //printf("strtok iteration: numargs=%d for <%s>\n",numargs, s);
-        ;
-    }
-        //printf("strtok iteration: numargs=%d for <%s>\n",numargs, s);
-
-    for( i = 0 ; i < numargs ; i++ )
+    /* each % starts one conversion; anything after it up to the next % is ignored */
+    for( numargs = 0 ; sp != NULL ; sp = strchr(sp, '%') )
     {
-        strcpy(string,"%");
-        strcat(string, arg[i]);
+        sp++;
+        for( k = 0 ; k < (int) (sizeof(convs)/sizeof(convs[0])) ; k++ )
+        {
+            if( strncmp( sp, convs[k].conv, strlen(convs[k].conv) ) == 0 ) break;
+        }
 
-        if( strstr(string, "%f") != NULL )
-            argtypes[i] = (int) FLOAT;
-        else
-        if( strstr(string, "%lf") != NULL )
-            argtypes[i] = (int) DOUBLE;
-        else
-        if( strstr(string, "%c") != NULL )
-            argtypes[i] = (int) CHAR;
-        else
-        if( strstr(string, "%hd") != NULL )
-            argtypes[i] = (int) SHORT;
-        else
-        if( strstr(string, "%d") != NULL )
-            argtypes[i] = (int) INT;
-        else
-        if( strstr(string, "%ld") != NULL )
-            argtypes[i] = (int) LINT;
-        else
-        if( strstr(string, "%s") != NULL )
-            argtypes[i] = (int) STRING;
-        else
-        if( strstr(string, "%u") != NULL )
-            argtypes[i] = (int) UINT;
-        else
-        if( strstr(string, "%x") != NULL )
-            argtypes[i] = (int) HEX;
-        else
+        if( k == (int) (sizeof(convs)/sizeof(convs[0])) )
         {
-#if SG_DEBUG
-            fprintf(stderr, "Parse_Format: Bad format <%s> len=%d arg0=%s\n",string,len,arg[0]);
-#endif
-            
-            free(scopy); /* memleak!!!! */
-            
             return(SG_ERROR_BAD_FORMAT_TYPE);
         }
+
+        argtypes[numargs++] = convs[k].type;
     }
-    
-    free(scopy); /* memleak!!!! */
 
-    //printf("final numargs=%d for <%s>\n",numargs, s);
     return( numargs );
 }
 
 
-static ANYTYPE getval(char *s, int type, int *flag)
+/* one token to a value of type; *flag is 0, or -1 if it doesn't convert */
+static ANYTYPE convertValue(char *s, int type, int *flag)
 {
     ANYTYPE value;
     value.d = 0.0;
@@ -1011,236 +2675,521 @@ static ANYTYPE getval(char *s, int type, int *flag)
     switch( type )
     {
         case CHAR:
-            if( sscanf( s, "%c", &value.c ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected character\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else  return( value );     
+            value.c = myread_char( s, flag );
+            break;
         case SHORT:
-            if( sscanf( s, "%hd", &value.h ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected short\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );     
+            value.h = myread_short( s, flag );
+            break;
         case INT:
-            if( sscanf( s, "%d", &value.i ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected integer\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );     
+            value.i = myread_int( s, flag );
+            break;
         case UINT:
-            if( sscanf( s, "%u", &value.ui ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected unsigned integer\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );
+            value.ui = myread_uint( s, flag );
+            break;
         case HEX:
-            if( sscanf( s, "%x", &value.ui ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected hex integer\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );
+            value.ui = myread_hex( s, flag );
+            break;
         case LINT:
-            if( sscanf( s, "%ld", &value.li ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected longeger\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );
+            value.li = myread_lint( s, flag );
+            break;
         case FLOAT:
-            if( sscanf( s, "%f", &value.f ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected float\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );     
+            value.f = myread_float( s, flag );
+            break;
         case DOUBLE:
-            if( sscanf( s, "%lf", &value.d ) != 1 )
-            {
-#if SG_DEBUG
-                fprintf(stderr," Getval: Bad argument. Expected double\n");
-#endif
-                *flag = -1;
-                return( value );
-            }
-            else return( value );     
+            value.d = myread_double( s, flag );
+            break;
+        case SIZE:
+            value.ull = myread_size( s, flag );
+            break;
+        case DURATION:
+            value.ll = myread_duration( s, flag );
+            break;
         case STRING:
-            //strcpy( value.string, s );
             value.string = s;
             return( value );
         default:
-#if SG_DEBUG
-            fprintf(stderr, "Getval: Bad argument type %d\n",type);
-#endif
             *flag = -1;
             return( value );
     }     
+
+    return( value );
 }
 
+/* the myread_* family converts a whole token or sets *flag to -1 */
 static char myread_char(char *s, int *flag)
 {
-    char x;
-    *flag = 0;
-    if( sscanf( s, "%c", &x ) != 1 || strlen(s) > 1 )
-    {
-        *flag = -1;
-    }
-    return( x );
+    *flag = ( s[0] != '\0' && s[1] == '\0' ) ? 0 : -1;
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( s[0] );
 }     
 static short myread_short(char *s, int *flag)
 {
-    short x;
-    *flag = 0;
-    if( sscanf( s, "%hd", &x ) != 1 )
-    {
-        *flag = -1;
-    }
-    return( x );
+    long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvSigned( s, SHRT_MIN, SHRT_MAX, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( (short) x );
 }     
 static int myread_int(char *s, int *flag)
 {
-    int x;
-    *flag = 0;
-    if( sscanf( s, "%d", &x ) != 1 )
-    {
-        *flag = -1;
-    }
-    return( x );
+    long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvSigned( s, INT_MIN, INT_MAX, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( (int) x );
 }     
 static unsigned int myread_uint(char *s, int *flag)
 {
-    unsigned int x;
-    *flag = 0;
-    if( sscanf( s, "%u", &x ) != 1 )
+    unsigned long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvUnsigned( s, 10, UINT_MAX, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( (unsigned int) x );
+}
+static unsigned int myread_hex(char *s, int *flag)
+{
+    unsigned long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvUnsigned( s, 16, UINT_MAX, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( (unsigned int) x );
+}
+static long myread_lint(char *s, int *flag)
+{
+    long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvSigned( s, LONG_MIN, LONG_MAX, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( (long) x );
+}
+static float myread_float(char *s, int *flag)
+{
+    float x = 0.0f;
+    SG_STATS_START( t );
+    *flag = sgConvFloat( s, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( x );
+}     
+static double myread_double(char *s, int *flag)
+{
+    double x = 0.0;
+    SG_STATS_START( t );
+    *flag = sgConvDouble( s, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( x );
+}     
+static unsigned long long myread_size(char *s, int *flag)
+{
+    unsigned long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvSize( s, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( x );
+}
+static long long myread_duration(char *s, int *flag)
+{
+    long long x = 0;
+    SG_STATS_START( t );
+    *flag = sgConvDuration( s, &x );
+    SG_STATS_STOP( convertNs, t );
+    SG_STATS_ADD( badConversions, *flag != 0 );
+    return( x );
+}
+ 
+/* >= 0 if s names an option, or in prefix mode starts one or more names, or is an option
+    with its value attached or a bundle */
+static int check_if_option(const superOptCtx_t *ctx, char *s, const superOptSpec_t *spec)
+{
+    char *value, *bundle;
+
+    if( findOption( ctx, spec, s ) != -1 ) return(1);
+    return( attachedOption( ctx, spec, s, &value, &bundle ) != -1 ? 1 : -1 );
+}
+
+#ifdef __cplusplus
+/* how many args a var list could take: all of them up to the next option name */
+static int countValues( const superOptCtx_t *ctx, const superOptSpec_t *spec, char **argv, int argsleft )
+{
+    int n = 0;
+
+    while( n < argsleft && check_if_option( ctx, argv[n], spec ) < 0 ) n++;
+    return( n );
+}
+
+/* one column of a list of tuples bound to std::vectors: append value, or with value NULL drop the last */
+template<class T> static void columnEdit( std::vector<T> *v, const ANYTYPE *value )
+{
+    if( value != NULL ) v->push_back( *(const T *) value );
+    else v->pop_back();
+}
+
+static void editColumn( PANYTYPE p, int type, const ANYTYPE *value )
+{
+    switch( type )
     {
-        *flag = -1;
+        case CHAR:   columnEdit( p.vc, value ); break;
+        case SHORT:  columnEdit( p.vh, value ); break;
+        case INT:    columnEdit( p.vi, value ); break;
+        case UINT:
+        case HEX:    columnEdit( p.vui, value ); break;
+        case LINT:   columnEdit( p.vli, value ); break;
+        case FLOAT:  columnEdit( p.vf, value ); break;
+        case DOUBLE: columnEdit( p.vd, value ); break;
+        case STRING: columnEdit( p.vcp, value ); break;
+        case SIZE:   columnEdit( p.vull, value ); break;
+        case DURATION: columnEdit( p.vll, value ); break;
     }
-    return( x );
 }
-static unsigned int myread_hex(char *s, int *flag)
+
+static void reserveVector( PANYTYPE *p, int type, int bind, int n )
 {
-    unsigned int x;
-    *flag = 0;
-    if( sscanf( s, "%x", &x ) != 1 )
+    switch( type )
     {
-        *flag = -1;
+        case CHAR:   p->vc->reserve( p->vc->size() + n ); break;
+        case SHORT:  p->vh->reserve( p->vh->size() + n ); break;
+        case INT:    p->vi->reserve( p->vi->size() + n ); break;
+        case UINT:
+        case HEX:    p->vui->reserve( p->vui->size() + n ); break;
+        case LINT:   p->vli->reserve( p->vli->size() + n ); break;
+        case FLOAT:  p->vf->reserve( p->vf->size() + n ); break;
+        case DOUBLE: p->vd->reserve( p->vd->size() + n ); break;
+        case SIZE:   p->vull->reserve( p->vull->size() + n ); break;
+        case DURATION: p->vll->reserve( p->vll->size() + n ); break;
+        case STRING:
+#if __cplusplus >= 201703L
+            if( bind == SG_BIND_VIEWS ) p->vsv->reserve( p->vsv->size() + n );
+            else
+#endif
+            p->vcp->reserve( p->vcp->size() + n );
+            break;
     }
-    return( x );
 }
-static long myread_lint(char *s, int *flag)
+#endif
+
+/* FNV-1a. Names are short, so this is cheaper than anything smarter */
+static unsigned int hashName( const char *s )
 {
-    long x;
-    *flag = 0;
-    if( sscanf( s, "%ld", &x ) != 1 )
+    unsigned int h = 2166136261u;
+
+    while( *s )
     {
-        *flag = -1;
+        h ^= (unsigned char) *s++;
+        h *= 16777619u;
     }
-    return( x );
+    return( h );
 }
-static float myread_float(char *s, int *flag)
+
+/* open addressed table over option names, at most half full. First definition of a name wins */
+static int buildNameIndex( superOptSpec_t *spec )
 {
-    float x;
-    *flag = 0;
-    if( sscanf( s, "%f", &x ) != 1 )
+    unsigned int size = 8;
+    unsigned int h, k;
+    int i, probe;
+
+    while( size < 2 * (unsigned int) spec->optnum ) size <<= 1;
+
+    spec->hashSlot = (int *) sgArenaAlloc( &spec->arena, size * sizeof(int) );
+    spec->hashVal = (unsigned int *) sgArenaAlloc( &spec->arena, size * sizeof(unsigned int) );
+    if( spec->hashSlot == NULL || spec->hashVal == NULL ) return( SG_ERROR_NO_MEMORY );
+
+    spec->hashMask = size - 1;
+    spec->hashMaxProbe = 0;
+    for( k = 0 ; k < size ; k++ ) spec->hashSlot[k] = -1;
+    memset( spec->nameStart, 0, sizeof(spec->nameStart) );
+
+    for( i = 0 ; i < spec->optnum ; i++ )
     {
-        *flag = -1;
+        h = hashName( spec->optionlist[i].name );
+        for( k = h & spec->hashMask, probe = 0 ; spec->hashSlot[k] >= 0 ; k = (k + 1) & spec->hashMask, probe++ )
+        {
+            if( spec->hashVal[k] == h && strcmp( spec->optionlist[spec->hashSlot[k]].name, spec->optionlist[i].name ) == 0 )
+                break;
+        }
+        if( spec->hashSlot[k] >= 0 ) continue; // duplicate name
+        
+        spec->nameStart[(unsigned char) spec->optionlist[i].name[0] >> 3] |= 1 << (spec->optionlist[i].name[0] & 7);
+        
+        spec->hashSlot[k] = i;
+        spec->hashVal[k] = h;
+        if( probe > spec->hashMaxProbe ) spec->hashMaxProbe = probe;
     }
-    return( x );
-}     
-static double myread_double(char *s, int *flag)
+
+    /* one character names, for bundles like -xvf */
+    memset( spec->shortOpt, 0, sizeof(spec->shortOpt) );
+    for( i = 0 ; i < spec->optnum ; i++ )
+    {
+        const char *name = spec->optionlist[i].name;
+
+        if( name[0] == '-' && name[1] != 0 && name[1] != '-' && name[1] != '=' && name[2] == 0 && lookupOption( spec, name ) == i )
+            spec->shortOpt[(unsigned char) name[1]] = i + 1;
+    }
+    return( buildNameOrder( spec ) );
+}
+
+static int compareNames( const void *a, const void *b )
 {
-    double x;
-    *flag = 0;
-    if( sscanf( s, "%lf", &x ) != 1 )
+    return( strcmp( (*(const struct optionlist_s * const *) a)->name, (*(const struct optionlist_s * const *) b)->name ) );
+}
+
+/* the distinct, non empty names sorted: names sharing a prefix are then next to each other */
+static int buildNameOrder( superOptSpec_t *spec )
+{
+    const struct optionlist_s **sorted;
+    int i;
+
+    spec->numNames = 0;
+    spec->byName = (int *) sgArenaAlloc( &spec->arena, (spec->optnum + 1) * sizeof(int) );
+    sorted = (const struct optionlist_s **) sgArenaAlloc( &spec->arena, (spec->optnum + 1) * sizeof(*sorted) );
+    if( spec->byName == NULL || sorted == NULL ) return( SG_ERROR_NO_MEMORY );
+
+    for( i = 0 ; i < spec->optnum ; i++ )
     {
-        *flag = -1;
+        const struct optionlist_s *opt = &spec->optionlist[i];
+
+        if( opt->name[0] != 0 && lookupOption( spec, opt->name ) == i ) sorted[spec->numNames++] = opt;
     }
-    return( x );
-}     
- 
-static int check_if_option(char *s, struct optionlist_s *optionlist, int numopts)
+    qsort( (void *) sorted, spec->numNames, sizeof(*sorted), compareNames );
+    for( i = 0 ; i < spec->numNames ; i++ ) spec->byName[i] = (int) (sorted[i] - spec->optionlist);
+    return(0);
+}
+
+/* the first name in order that starts with prefix (past set: that comes after all of those) */
+static int searchNames( const superOptSpec_t *spec, const char *prefix, size_t len, int past )
+{
+    int lo = 0, hi = spec->numNames, mid, c;
+
+    while( lo < hi )
+    {
+        mid = lo + (hi - lo) / 2;
+        c = strncmp( spec->optionlist[spec->byName[mid]].name, prefix, len );
+        if( c < 0 || (past && c == 0) ) lo = mid + 1;
+        else hi = mid;
+    }
+    return( lo );
+}
+
+/* the option whose name starts with s[0..len), if exactly one does: -1 if none, SG_AMBIGUOUS if
+    several. Only option-like words, with something after their leading '-'s or '+'s */
+static int prefixOption( const superOptSpec_t *spec, const char *s, size_t len )
+{
+    int found = -1, k;
+
+    if( spec->byName == NULL || (s[0] != '-' && s[0] != '+') || strspn( s, s[0] == '-' ? "-" : "+" ) >= len ) return( -1 );
+
+    SG_STATS_START( t );
+    k = searchNames( spec, s, len, 0 );
+    if( k < spec->numNames && strncmp( spec->optionlist[spec->byName[k]].name, s, len ) == 0 )
+    {
+        found = spec->byName[k];
+        if( k + 1 < spec->numNames && strncmp( spec->optionlist[spec->byName[k+1]].name, s, len ) == 0 ) found = SG_AMBIGUOUS;
+    }
+    SG_STATS_STOP( lookupNs, t );
+    SG_STATS_ADD( lookups, 1 );
+
+    return( found );
+}
+
+/* lookupOption, or in prefix mode a unique start of a name as well */
+static int findOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, const char *s )
 {
+    int i = lookupOption( spec, s );
+
+    if( i < 0 && ctx->nameMode == SG_NAMES_PREFIX ) i = prefixOption( spec, s, strlen( s ) );
+    return(i);
+}
 
+/* an option given with its first value in the same arg, "--name=value" or "-nvalue", or a bundle
+    of one character options, "-xvf": the option (of a bundle, the first), else -1. *pValue is the
+    attached value and *pBundle the rest of the bundle, or NULL. Nothing is copied: they point into s */
+static int attachedOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, char *s, char **pValue, char **pBundle )
+{
+    char *eq;
     int i;
 
-    for( i = 0 ; i < numopts ; i++ )
+    *pValue = NULL;
+    *pBundle = NULL;
+    if( s[0] != '-' || s[1] == 0 ) return( -1 );
+
+    if( (eq = strchr( s + 1, '=' )) != NULL )
     {
-        if( strcmp( s, optionlist[i].name ) == 0 )
-            return( i );
+        i = lookupOptionN( spec, s, (size_t) (eq - s) );
+        if( i == -1 && ctx->nameMode == SG_NAMES_PREFIX ) i = prefixOption( spec, s, (size_t) (eq - s) );
+        if( i != -1 )
+        {
+            *pValue = eq + 1;
+            return(i);
+        }
     }
+    return( s[1] == '-' ? -1 : shortOption( spec, s + 1, pValue, pBundle ) );
+}
 
-    return( -1 );
+static int takesValues( const struct optionlist_s *opt )
+{
+    return( opt->numargs > 0 || opt->varflag == 1 );
 }
 
-static int groupUnaccArgs( int argc, char *argv[], int *pLastArg, int unAccountedFor, int numUnaccGroups, unaccArgsList_t *unaccountedForIndex, int argOffset )
+/* s is the rest of a bundle: the option named by s[0]. If it takes values, the rest of s is
+    its first one; if not, the rest is more of the bundle. -1 unless all of s works out */
+static int shortOption( const superOptSpec_t *spec, char *s, char **pValue, char **pBundle )
 {
-    int i, j, k;
-    int numToBeMoved = 0;
-    int lastNonConsec = 0;
+    const char *c;
+    int i;
 
-    if( numUnaccGroups > 0 ) lastNonConsec = unaccountedForIndex[numUnaccGroups-1].start;
-    
-    /* pass 1: how many unaccounted for args until the end of the command line? */
-    for( i = 0 ; i < numUnaccGroups-1 ; i++ )
+    *pValue = NULL;
+    *pBundle = NULL;
+    for( c = s ; *c ; c++ )
     {
-        numToBeMoved += unaccountedForIndex[i].stop-unaccountedForIndex[i].start+1;
+        i = spec->shortOpt[(unsigned char) *c] - 1;
+        if( i < 0 ) return( -1 );
+        if( takesValues( &spec->optionlist[i] ) ) break;
     }
-   
-    //fprintf(stderr, "Last non-consecutive extra arg index = %d numToMove=%d\n", lastNonConsec,numToBeMoved);
-    
-    /* Move all non-consecs to start of consecutive ones at end of line */
-    /* Leave last set in place, but move all non-consecs to right before last block of consecs */
-    /* Do this in reverse order to ensure nothing gets stepped on */
-    for( i = numUnaccGroups-2, k = 1 ; i >= 0 ; i-- )
+    if( s[0] == 0 ) return( -1 );
+
+    i = spec->shortOpt[(unsigned char) s[0]] - 1;
+    if( s[1] != 0 )
+    {
+        if( takesValues( &spec->optionlist[i] ) ) *pValue = s + 1;
+        else *pBundle = s + 1;
+    }
+    return(i);
+}
+
+int superCompleteSpec( const superOptSpec_t *spec, const char *prefix, const char **names, int maxNames )
+{
+    size_t len;
+    int first, past, k;
+
+    if( spec == NULL || spec->byName == NULL ) return(0);
+    if( prefix == NULL ) prefix = "";
+
+    len = strlen( prefix );
+    first = searchNames( spec, prefix, len, 0 );
+    past = searchNames( spec, prefix, len, 1 );
+    for( k = first ; k < past && k - first < maxNames && names != NULL ; k++ ) names[k - first] = spec->optionlist[spec->byName[k]].name;
+    return( past - first );
+}
+
+int superComplete( const char *prefix, const char **names, int maxNames )
+{
+    superOptCtx_t *ctx = getThreadCtx();
+
+    return( superCompleteSpec( ctx ? ctx->spec : NULL, prefix, names, maxNames ) );
+}
+
+static int lookupOption( const superOptSpec_t *spec, const char *s )
+{
+    unsigned int h, k;
+    int probe, found = -1;
+
+    if( spec->hashSlot == NULL ) return( -1 );     /* not (successfully) compiled */
+    if( !(spec->nameStart[(unsigned char) s[0] >> 3] & (1 << (s[0] & 7))) ) return( -1 );
+
+    SG_STATS_START( t );
+    h = hashName( s );
+    for( k = h & spec->hashMask, probe = 0 ; probe <= spec->hashMaxProbe && spec->hashSlot[k] >= 0 ; k = (k + 1) & spec->hashMask, probe++ )
     {
-        for( j = unaccountedForIndex[i].stop ; j >= unaccountedForIndex[i].start ; j--, k++ )
+        if( spec->hashVal[k] == h && strcmp( spec->optionlist[spec->hashSlot[k]].name, s ) == 0 )
         {
-            char *pTmp = NULL;
-            /* swap positions */
-            int index;
-            
-            index = lastNonConsec-k;
-            //printf("Swapping %d with %d\n", j,index);
-            pTmp = argv[index-argOffset];
-            argv[index-argOffset] = argv[j-argOffset];
-            argv[j-argOffset] = pTmp;
-            //printf("Done. Argv[%d]=%s\n", index-argOffset,argv[index-argOffset]);
+            found = spec->hashSlot[k];
+            break;
         }
     }
-    
-    if( pLastArg != NULL ) *pLastArg -= numToBeMoved;
+    SG_STATS_STOP( lookupNs, t );
+    SG_STATS_ADD( lookups, 1 );
+
+    return( found );
+}
+
+/* lookupOption for the name s[0..len), which needn't end there: "--name" of "--name=value" */
+static int lookupOptionN( const superOptSpec_t *spec, const char *s, size_t len )
+{
+    unsigned int h = 2166136261u, k;
+    size_t n;
+    int probe, found = -1;
+
+    if( spec->hashSlot == NULL || len == 0 ) return( -1 );
+    if( !(spec->nameStart[(unsigned char) s[0] >> 3] & (1 << (s[0] & 7))) ) return( -1 );
+
+    SG_STATS_START( t );
+    for( n = 0 ; n < len ; n++ )
+    {
+        h ^= (unsigned char) s[n];
+        h *= 16777619u;
+    }
+    for( k = h & spec->hashMask, probe = 0 ; probe <= spec->hashMaxProbe && spec->hashSlot[k] >= 0 ; k = (k + 1) & spec->hashMask, probe++ )
+    {
+        const char *name = spec->optionlist[spec->hashSlot[k]].name;
+
+        if( spec->hashVal[k] == h && strncmp( name, s, len ) == 0 && name[len] == 0 )
+        {
+            found = spec->hashSlot[k];
+            break;
+        }
+    }
+    SG_STATS_STOP( lookupNs, t );
+    SG_STATS_ADD( lookups, 1 );
+
+    return( found );
+}
+
+/* extra args were found at the positions in ctx->unaccountedForIndex, counted like lastArg, so
+    position p is argv[p-1]. Group them: one stable partition of argv from the first extra to the
+    last, options to the front and extras to the back, in one pass. Or, in span mode, leave argv
+    alone. Either way *lastArg ends up at the first extra. Returns the number of extras */
+static int placeExtras( superOptCtx_t *ctx, char **argv, int *lastArg )
+{
+    superArgSpan_t *span = ctx->unaccountedForIndex;
+
+#if SG_GROUP_UNACC_ARGS
+    if( ctx->extrasMode == SG_EXTRAS_GROUP && ctx->numUnaccGroups > 1 )
+    {
+        int numSpans = ctx->numUnaccGroups;
+        int numToBeMoved, i, k, w;
+        SG_STATS_START( t );
+
+        /* the last span stays put; every other extra goes in front of it */
+        numToBeMoved = ctx->unAccountedFor - span[numSpans-1].count;
+        if( numToBeMoved > ctx->extraArgsCap )
+        {
+            char **list = (char **) realloc( ctx->extraArgs, numToBeMoved * sizeof(char *) );
+            SG_STATS_ADD( allocs, 1 );
+
+            if( list == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+            ctx->extraArgs = list;
+            ctx->extraArgsCap = numToBeMoved;
+        }
+
+        for( i = 0, k = 0, w = span[0].start - 1 ; i < numSpans - 1 ; i++ )
+        {
+            int gap = span[i+1].start - (span[i].start + span[i].count);
+
+            memcpy( ctx->extraArgs + k, argv + span[i].start - 1, span[i].count * sizeof(char *) );
+            k += span[i].count;
+            memmove( argv + w, argv + span[i].start - 1 + span[i].count, gap * sizeof(char *) );
+            w += gap;
+        }
+        memcpy( argv + w, ctx->extraArgs, numToBeMoved * sizeof(char *) );
+
+        span[0].start = w + 1;
+        span[0].count = ctx->unAccountedFor;
+        ctx->numUnaccGroups = 1;
+        SG_STATS_STOP( groupNs, t );
+    }
+#endif
 
-    return 0;
+    if( lastArg != NULL ) *lastArg = span[0].start;
+    return( ctx->unAccountedFor );
 }
 
 void usage()
 {
-	int argErr;
-	superGetOpt(0, NULL, &argErr, NULL); // prints help info
+	superCtxUsage( getThreadCtx() ); // prints help info from the last superGetOpt() call
 }
@@ -0,0 +1,123 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* A small arena for the parse context: many small allocations, one free.
+    Blocks double in size, so n bytes cost O(log n) mallocs.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "superGetOptInt.h"
+
+#define ARENA_FIRST_BLOCK 4096
+#define ARENA_ALIGN 16
+
+struct sgArenaBlock_s
+{
+    sgArenaBlock_t *next;
+    size_t size;                /* usable bytes after the header */
+};
+
+#define BLOCK_HEADER ((sizeof(sgArenaBlock_t) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+/* a new head block with at least want bytes, twice the size of the last */
+static sgArenaBlock_t *newBlock( sgArena_t *arena, size_t want )
+{
+    sgArenaBlock_t *b = arena->head;
+    size_t bsize = b ? 2 * b->size : ARENA_FIRST_BLOCK;
+
+    while( bsize < want ) bsize *= 2;
+    b = (sgArenaBlock_t *) malloc( BLOCK_HEADER + bsize );
+    SG_STATS_ADD( allocs, 1 );
+    if( b == NULL ) return( NULL );
+    b->next = arena->head;
+    b->size = bsize;
+    arena->head = b;
+    arena->used = 0;
+    return( b );
+}
+
+void *sgArenaAlloc( sgArena_t *arena, size_t size )
+{
+    sgArenaBlock_t *b = arena->head;
+    size_t want = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+    if( b == NULL || arena->used + want > b->size )
+    {
+        b = newBlock( arena, want );
+        if( b == NULL ) return( NULL );
+    }
+
+    arena->used += want;
+    return( (char *) b + BLOCK_HEADER + arena->used - want );
+}
+
+void sgArenaReserve( sgArena_t *arena, size_t size, int count )
+{
+    size_t want = size + (size_t) count * (ARENA_ALIGN - 1);
+
+    if( arena->head == NULL || arena->used + want > arena->head->size ) newBlock( arena, want );
+}
+
+char *sgArenaStrdup( sgArena_t *arena, const char *s )
+{
+    size_t len = strlen( s ) + 1;
+    char *d = (char *) sgArenaAlloc( arena, len );
+
+    if( d != NULL ) memcpy( d, s, len );
+    return( d );
+}
+
+/* drop everything but the largest (newest) block, which is kept for reuse */
+void sgArenaReset( sgArena_t *arena )
+{
+    sgArenaBlock_t *b, *next;
+
+    if( arena->head == NULL ) return;
+
+    for( b = arena->head->next ; b != NULL ; b = next )
+    {
+        next = b->next;
+        free( b );
+    }
+    arena->head->next = NULL;
+    arena->used = 0;
+}
+
+void sgArenaRelease( sgArena_t *arena )
+{
+    sgArenaBlock_t *b, *next;
+
+    for( b = arena->head ; b != NULL ; b = next )
+    {
+        next = b->next;
+        free( b );
+    }
+    arena->head = NULL;
+    arena->used = 0;
+}
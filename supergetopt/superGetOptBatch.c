@@ -0,0 +1,243 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* Batch parsing: many argument vectors against one compiled spec, spread over
+    a pool of worker threads. Each worker owns a range of records and takes
+    them from the front; a worker that runs dry steals the back half of the
+    fullest range it can find. Every record is parsed by superCtxParseSpec,
+    so statuses and lastArg positions are exactly what the serial call gives.
+*/
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "supergetopt.h"
+#include "superGetOptInt.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define BATCH_CHUNK 16       /* records a worker takes from its own range at a time */
+#define BATCH_MAX_THREADS 256
+
+typedef struct
+{
+    const superOptSpec_t *spec;
+    const void *bindBase;
+    size_t bindSize;
+    superBatchRec_t *recs;
+    const superOptCtx_t *modes; /* the calling thread's context: the workers take its modes */
+} batchJob_t;
+
+static void parseRecords( superOptCtx_t *ctx, const batchJob_t *job, int lo, int hi )
+{
+    int r;
+
+    for( r = lo ; r < hi ; r++ )
+    {
+        superBatchRec_t *rec = &job->recs[r];
+
+        sgCtxSetOutput( ctx, job->bindBase, job->bindSize, rec->outBase );
+        if( job->modes != NULL ) sgCtxCopyModes( ctx, job->modes );
+        else superCtxSetDiagMode( ctx, SG_DIAG_QUIET );
+        rec->status = superCtxParseSpec( ctx, job->spec, rec->argc, rec->argv, &rec->lastArg );
+    }
+}
+
+#ifndef _WIN32
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    int lo, hi;                 /* records not yet taken */
+} batchQueue_t;
+
+typedef struct
+{
+    const batchJob_t *job;
+    batchQueue_t *queues;
+    int numQueues;
+    int self;
+} batchWorker_t;
+
+/* take up to BATCH_CHUNK records from the front of our own range */
+static int takeOwn( batchQueue_t *q, int *pLo, int *pHi )
+{
+    int n;
+
+    pthread_mutex_lock( &q->lock );
+    n = q->hi - q->lo;
+    if( n > BATCH_CHUNK ) n = BATCH_CHUNK;
+    *pLo = q->lo;
+    *pHi = q->lo + n;
+    q->lo += n;
+    pthread_mutex_unlock( &q->lock );
+
+    return( n > 0 );
+}
+
+/* move the back half of the fullest other range into ours */
+static int steal( batchWorker_t *w )
+{
+    batchQueue_t *mine = &w->queues[w->self];
+    batchQueue_t *victim;
+    int v, best, bestLeft, lo, hi;
+
+    for( ;; )
+    {
+        best = -1;
+        bestLeft = 0;
+        for( v = 0 ; v < w->numQueues ; v++ )
+        {
+            int left;
+            if( v == w->self ) continue;
+            pthread_mutex_lock( &w->queues[v].lock );
+            left = w->queues[v].hi - w->queues[v].lo;
+            pthread_mutex_unlock( &w->queues[v].lock );
+            if( left > bestLeft ) { best = v; bestLeft = left; }
+        }
+        if( best < 0 ) return(0);
+
+        victim = &w->queues[best];
+        pthread_mutex_lock( &victim->lock );
+        hi = victim->hi;
+        lo = victim->lo + (victim->hi - victim->lo) / 2;    /* a single record is taken whole */
+        victim->hi = lo;
+        pthread_mutex_unlock( &victim->lock );
+
+        if( lo < hi ) break;    /* else the victim drained meanwhile; look again */
+    }
+
+    pthread_mutex_lock( &mine->lock );
+    mine->lo = lo;
+    mine->hi = hi;
+    pthread_mutex_unlock( &mine->lock );
+    return(1);
+}
+
+static void *batchWorker( void *arg )
+{
+    batchWorker_t *w = (batchWorker_t *) arg;
+    superOptCtx_t *ctx = superCtxNew();
+    int lo, hi;
+
+    if( ctx == NULL ) return( arg );     /* not started: the caller parses what is left */
+
+    for( ;; )
+    {
+        if( takeOwn( &w->queues[w->self], &lo, &hi ) ) parseRecords( ctx, w->job, lo, hi );
+        else if( !steal( w ) ) break;
+    }
+
+    superCtxFree( ctx );
+    return( NULL );
+}
+
+#endif
+
+int superParseBatch( const superOptSpec_t *spec, const void *bindBase, size_t bindSize, superBatchRec_t *recs, int numRecs, int numThreads )
+{
+    batchJob_t job;
+    superOptCtx_t *ctx;
+    int n = 0;
+
+    if( spec == NULL || (recs == NULL && numRecs > 0) ) return( SG_ERROR_MISSING_ARG );
+    if( !sgSpecBoundWithin( spec, bindBase, bindSize ) ) return( SG_ERROR_BAD_BINDING );
+
+    job.spec = spec;
+    job.bindBase = bindBase;
+    job.bindSize = bindSize;
+    job.recs = recs;
+    job.modes = sgThreadCtx();
+
+#ifndef _WIN32
+    if( numThreads <= 0 ) numThreads = (int) sysconf( _SC_NPROCESSORS_ONLN );
+    if( numThreads > BATCH_MAX_THREADS ) numThreads = BATCH_MAX_THREADS;
+    if( numThreads > numRecs / BATCH_CHUNK ) numThreads = numRecs / BATCH_CHUNK;
+
+    if( numThreads > 1 )
+    {
+        pthread_t threads[BATCH_MAX_THREADS];
+        batchQueue_t queues[BATCH_MAX_THREADS];
+        batchWorker_t workers[BATCH_MAX_THREADS];
+        int t, started = 0;
+
+        for( t = 0 ; t < numThreads ; t++ )
+        {
+            pthread_mutex_init( &queues[t].lock, NULL );
+            queues[t].lo = (int) ((long long) numRecs * t / numThreads);
+            queues[t].hi = (int) ((long long) numRecs * (t + 1) / numThreads);
+            workers[t].job = &job;
+            workers[t].queues = queues;
+            workers[t].numQueues = numThreads;
+            workers[t].self = t;
+        }
+
+        /* the calling thread is worker 0 */
+        for( t = 1 ; t < numThreads ; t++ )
+        {
+            if( pthread_create( &threads[t], NULL, batchWorker, &workers[t] ) == 0 ) started++;
+            else break;
+        }
+        batchWorker( &workers[0] );
+        for( t = 1 ; t <= started ; t++ ) pthread_join( threads[t], NULL );
+
+        /* ranges left behind by a worker that never started (no thread or no context) */
+        for( t = 0 ; t < numThreads ; t++ )
+        {
+            if( queues[t].lo < queues[t].hi )
+            {
+                ctx = superCtxNew();
+                if( ctx == NULL ) n = SG_ERROR_NO_MEMORY;
+                else
+                {
+                    parseRecords( ctx, &job, queues[t].lo, queues[t].hi );
+                    superCtxFree( ctx );
+                }
+            }
+            pthread_mutex_destroy( &queues[t].lock );
+        }
+        return(n);
+    }
+#else
+    (void) numThreads;
+#endif
+
+    /* serial */
+    ctx = superCtxNew();
+    if( ctx == NULL ) return( SG_ERROR_NO_MEMORY );
+    parseRecords( ctx, &job, 0, numRecs );
+    superCtxFree( ctx );
+
+    return(0);
+}
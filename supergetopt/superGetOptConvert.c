@@ -0,0 +1,579 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+/* Locale independent string to number conversion for superGetOpt.
+    Every converter consumes the whole token and checks range; anything
+    else is a bad argument. Floating point results are correctly rounded:
+    exact cases go through one IEEE multiply or divide, everything else
+    through a big integer quotient. Sizes and durations stay in integers:
+    a fraction times its unit is worked out a digit at a time.
+*/
+
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include "superGetOptConvert.h"
+
+#define MAXDIGITS 800   /* significant digits kept; more than the 768 a double can need */
+#define BIGLIMBS  140   /* 32 bit limbs, enough for 10^1130 shifted by a mantissa */
+#define EXP10_LIMIT 2000    /* |exp10| kept: past it any MAXDIGITS digits are far out of range or 0 */
+
+typedef struct
+{
+    int len;
+    unsigned int limb[BIGLIMBS];
+} bigint_t;
+
+typedef struct
+{
+    int negative;
+    int special;                /* 1 inf, 2 nan */
+    int ndigits;                /* significant digits, leading zeros stripped */
+    int exp10;                  /* value = digits * 10^exp10 */
+    unsigned long long w;       /* first 19 significant digits */
+    int truncated;              /* more than 19 significant digits */
+    char digits[MAXDIGITS+1];
+} decimal_t;
+
+static const double pow10d[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+static const float pow10f[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+static int parseDecimal( const char *s, decimal_t *dec );
+static const char *scanNumber( const char *s, const char **pPoint );
+static int scaleNumber( const char *s, const char *point, const char *end, unsigned long long mult, unsigned long long max, unsigned long long *pVal );
+static int matchWord( const char *s, const char *word );
+static void decToBin( const decimal_t *dec, int mantBits, int minExp, int maxExp, unsigned long long *pMant, int *pExp2 );
+
+int sgConvSigned( const char *s, long long min, long long max, long long *pVal )
+{
+    unsigned long long x = 0;
+    unsigned long long limit;
+    int negative = 0;
+    unsigned int d;
+
+    if( s == NULL ) return(-1);
+
+    if( *s == '-' ) { negative = 1; s++; }
+    else if( *s == '+' ) s++;
+
+    if( *s < '0' || *s > '9' ) return(-1);
+
+    limit = negative ? (unsigned long long) -(min + 1) + 1 : (unsigned long long) max;
+
+    for( ; *s ; s++ )
+    {
+        d = (unsigned int) (*s - '0');
+        if( d > 9 ) return(-1);
+        if( x > (limit - d) / 10 ) return(-1);   /* out of range */
+        x = x * 10 + d;
+    }
+
+    if( negative )
+    {
+        if( min >= 0 && x != 0 ) return(-1);
+        *pVal = (x == 0) ? 0 : -(long long) (x - 1) - 1;
+    }
+    else *pVal = (long long) x;
+
+    return(0);
+}
+
+int sgConvUnsigned( const char *s, int base, unsigned long long max, unsigned long long *pVal )
+{
+    unsigned long long x = 0;
+    unsigned int d;
+
+    if( s == NULL ) return(-1);
+
+    if( *s == '+' ) s++;
+    if( base == 16 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X') ) s += 2;
+
+    if( *s == '\0' ) return(-1);
+
+    for( ; *s ; s++ )
+    {
+        if( *s >= '0' && *s <= '9' ) d = (unsigned int) (*s - '0');
+        else if( base == 16 && *s >= 'a' && *s <= 'f' ) d = (unsigned int) (*s - 'a' + 10);
+        else if( base == 16 && *s >= 'A' && *s <= 'F' ) d = (unsigned int) (*s - 'A' + 10);
+        else return(-1);
+
+        if( d > max || x > (max - d) / (unsigned int) base ) return(-1);   /* out of range */
+        x = x * (unsigned int) base + d;
+    }
+
+    *pVal = x;
+    return(0);
+}
+
+int sgConvDouble( const char *s, double *pVal )
+{
+    decimal_t dec;
+    unsigned long long mant;
+    int exp2;
+    double x;
+
+    if( s == NULL || parseDecimal( s, &dec ) != 0 ) return(-1);
+
+    if( dec.special == 1 ) x = HUGE_VAL;
+    else if( dec.special == 2 ) x = NAN;
+    else if( dec.ndigits == 0 ) x = 0.0;
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    else if( !dec.truncated && dec.w <= (1ULL << 53) && dec.exp10 >= -22 && dec.exp10 <= 22 )
+    {
+        /* both operands exact, so the one rounding IEEE does is the right one */
+        x = (double) dec.w;
+        x = dec.exp10 < 0 ? x / pow10d[-dec.exp10] : x * pow10d[dec.exp10];
+    }
+#endif
+    else
+    {
+        decToBin( &dec, DBL_MANT_DIG, DBL_MIN_EXP - DBL_MANT_DIG, DBL_MAX_EXP - DBL_MANT_DIG, &mant, &exp2 );
+        x = ldexp( (double) mant, exp2 );
+        if( x > DBL_MAX ) return(-1);   /* rounds past the largest double: out of range */
+    }
+
+    *pVal = dec.negative ? -x : x;
+    return(0);
+}
+
+int sgConvFloat( const char *s, float *pVal )
+{
+    decimal_t dec;
+    unsigned long long mant;
+    int exp2;
+    float x;
+
+    if( s == NULL || parseDecimal( s, &dec ) != 0 ) return(-1);
+
+    if( dec.special == 1 ) x = HUGE_VALF;
+    else if( dec.special == 2 ) x = NAN;
+    else if( dec.ndigits == 0 ) x = 0.0f;
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    else if( !dec.truncated && dec.w <= (1ULL << 24) && dec.exp10 >= -10 && dec.exp10 <= 10 )
+    {
+        x = (float) dec.w;
+        x = dec.exp10 < 0 ? x / pow10f[-dec.exp10] : x * pow10f[dec.exp10];
+    }
+#endif
+    else
+    {
+        decToBin( &dec, FLT_MANT_DIG, FLT_MIN_EXP - FLT_MANT_DIG, FLT_MAX_EXP - FLT_MANT_DIG, &mant, &exp2 );
+        x = ldexpf( (float) mant, exp2 );
+        if( x > FLT_MAX ) return(-1);   /* rounds past the largest float: out of range */
+    }
+
+    *pVal = dec.negative ? -x : x;
+    return(0);
+}
+
+int sgConvSize( const char *s, unsigned long long *pVal )
+{
+    static const char prefixes[] = "KMGTPE";
+    const char *point, *end, *p, *prefix;
+    unsigned long long mult = 1;
+    int k, n;
+
+    if( s == NULL ) return(-1);
+    if( *s == '+' ) s++;
+    if( (end = scanNumber( s, &point )) == NULL ) return(-1);
+
+    p = end;
+    if( *p != '\0' && (prefix = strchr( prefixes, *p == 'k' ? 'K' : *p )) != NULL )
+    {
+        n = (int) (prefix - prefixes) + 1;
+        if( *++p == 'i' )
+        {
+            mult = 1ULL << (10 * n);
+            p++;
+        }
+        else for( k = 0 ; k < n ; k++ ) mult *= 1000;
+    }
+    if( *p == 'B' ) p++;
+    if( *p != '\0' ) return(-1);
+
+    return( scaleNumber( s, point, end, mult, ULLONG_MAX, pVal ) );
+}
+
+int sgConvDuration( const char *s, long long *pVal )
+{
+    /* longer names first, so "ms" is not taken for minutes */
+    static const struct { const char *name; unsigned long long ns; } units[] =
+    {
+        { "ns", 1ULL }, { "us", 1000ULL }, { "\xc2\xb5s", 1000ULL }, { "\xce\xbcs", 1000ULL }, { "ms", 1000000ULL },
+        { "s", 1000000000ULL }, { "m", 60000000000ULL }, { "h", 3600000000000ULL }, { "d", 86400000000000ULL }
+    };
+    const char *point, *end;
+    unsigned long long limit, total = 0, part;
+    int k, negative = 0;
+
+    if( s == NULL ) return(-1);
+
+    if( *s == '-' ) { negative = 1; s++; }
+    else if( *s == '+' ) s++;
+
+    if( s[0] == '0' && s[1] == '\0' )
+    {
+        *pVal = 0;
+        return(0);
+    }
+    if( *s == '\0' ) return(-1);
+
+    limit = negative ? (unsigned long long) LLONG_MAX + 1 : (unsigned long long) LLONG_MAX;
+
+    while( *s )
+    {
+        if( (end = scanNumber( s, &point )) == NULL ) return(-1);
+        for( k = 0 ; k < (int) (sizeof(units)/sizeof(units[0])) ; k++ )
+        {
+            if( strncmp( end, units[k].name, strlen( units[k].name ) ) == 0 ) break;
+        }
+        if( k == (int) (sizeof(units)/sizeof(units[0])) ) return(-1);
+        if( scaleNumber( s, point, end, units[k].ns, limit - total, &part ) != 0 ) return(-1);   /* out of range */
+        total += part;
+        s = end + strlen( units[k].name );
+    }
+
+    *pVal = (negative && total != 0) ? -(long long) (total - 1) - 1 : (long long) total;
+    return(0);
+}
+
+/* digits [. [digits]] or . digits: the end of the number, with *pPoint at its '.' (or its end) */
+static const char *scanNumber( const char *s, const char **pPoint )
+{
+    int digits = 0;
+
+    for( ; *s >= '0' && *s <= '9' ; s++ ) digits++;
+    *pPoint = s;
+    if( *s == '.' )
+    {
+        for( s++ ; *s >= '0' && *s <= '9' ; s++ ) digits++;
+    }
+    return( digits > 0 ? s : NULL );
+}
+
+/* the number in [s, end) times mult, rounded down, if it is no more than max. mult is at
+    most 2^60, so d * mult + a value below mult fits and the fraction is exact */
+static int scaleNumber( const char *s, const char *point, const char *end, unsigned long long mult, unsigned long long max, unsigned long long *pVal )
+{
+    unsigned long long x = 0, frac = 0;
+    unsigned int d;
+
+    for( ; s < point ; s++ )
+    {
+        d = (unsigned int) (*s - '0');
+        if( d > max || x > (max - d) / 10 ) return(-1);
+        x = x * 10 + d;
+    }
+    if( x > max / mult ) return(-1);
+    x *= mult;
+
+    /* 0.d1d2..dn times mult, from dn back: floor((dk * mult + rest) / 10) loses nothing */
+    for( s = end - 1 ; s > point ; s-- ) frac = ((unsigned long long) (*s - '0') * mult + frac) / 10;
+
+    if( frac > max - x ) return(-1);
+    *pVal = x + frac;
+    return(0);
+}
+
+/* case insensitive match of the rest of the token against a lower case word */
+static int matchWord( const char *s, const char *word )
+{
+    for( ; *word ; s++, word++ )
+    {
+        if( *s != *word && *s != *word - ('a' - 'A') ) return(0);
+    }
+    return( *s == '\0' );
+}
+
+/* [+-] (digits [. [digits]] | . digits) [(e|E) [+-] digits], or inf, infinity, nan */
+static int parseDecimal( const char *s, decimal_t *dec )
+{
+    int sawDigit = 0;
+    int sawPoint = 0;
+    int tailNonZero = 0;
+    int exp = 0;
+    int expNeg = 0;
+    int expDigits = 0;
+    int k;
+
+    dec->negative = 0;
+    dec->special = 0;
+    dec->ndigits = 0;
+    dec->exp10 = 0;
+    dec->w = 0;
+    dec->truncated = 0;
+
+    if( *s == '-' ) { dec->negative = 1; s++; }
+    else if( *s == '+' ) s++;
+
+    if( matchWord( s, "inf" ) || matchWord( s, "infinity" ) ) { dec->special = 1; return(0); }
+    if( matchWord( s, "nan" ) ) { dec->special = 2; return(0); }
+
+    for( ; *s ; s++ )
+    {
+        if( *s >= '0' && *s <= '9' )
+        {
+            sawDigit = 1;
+            if( *s == '0' && dec->ndigits == 0 )
+            {
+                if( sawPoint ) dec->exp10--;        /* leading zero */
+            }
+            else if( dec->ndigits < MAXDIGITS - 1 )
+            {
+                dec->digits[dec->ndigits++] = *s;
+                if( sawPoint ) dec->exp10--;
+            }
+            else
+            {
+                /* too many to keep: drop it, but remember a non-zero tail */
+                if( *s != '0' ) tailNonZero = 1;
+                if( !sawPoint ) dec->exp10++;
+            }
+        }
+        else if( *s == '.' && !sawPoint ) sawPoint = 1;
+        else break;
+    }
+
+    if( !sawDigit ) return(-1);
+
+    if( *s == 'e' || *s == 'E' )
+    {
+        s++;
+        if( *s == '-' ) { expNeg = 1; s++; }
+        else if( *s == '+' ) s++;
+
+        for( ; *s >= '0' && *s <= '9' ; s++, expDigits++ )
+        {
+            if( exp < 100000 ) exp = exp * 10 + (*s - '0');
+        }
+        if( expDigits == 0 ) return(-1);
+        dec->exp10 += expNeg ? -exp : exp;
+    }
+
+    if( *s != '\0' ) return(-1);   /* trailing junk */
+
+    if( tailNonZero )
+    {
+        /* a sticky digit below everything kept decides ties correctly */
+        dec->digits[dec->ndigits++] = '1';
+        dec->exp10--;
+    }
+    else
+    {
+        /* trailing zeros only scale the exponent */
+        while( dec->ndigits > 0 && dec->digits[dec->ndigits - 1] == '0' )
+        {
+            dec->ndigits--;
+            dec->exp10++;
+        }
+    }
+
+    /* a huge exponent says no more than a clamped one, and keeps decToBin's range check in an int */
+    if( dec->exp10 > EXP10_LIMIT ) dec->exp10 = EXP10_LIMIT;
+    if( dec->exp10 < -EXP10_LIMIT ) dec->exp10 = -EXP10_LIMIT;
+
+    dec->truncated = dec->ndigits > 19;
+    for( k = 0 ; k < dec->ndigits && k < 19 ; k++ ) dec->w = dec->w * 10 + (unsigned int) (dec->digits[k] - '0');
+
+    return(0);
+}
+
+/*********************************** slow path ***********************************/
+
+static void bigSetSmall( bigint_t *a, unsigned int v )
+{
+    a->len = v ? 1 : 0;
+    a->limb[0] = v;
+}
+
+static void bigMulAdd( bigint_t *a, unsigned int mul, unsigned int add )
+{
+    unsigned long long carry = add;
+    int i;
+
+    for( i = 0 ; i < a->len ; i++ )
+    {
+        carry += (unsigned long long) a->limb[i] * mul;
+        a->limb[i] = (unsigned int) carry;
+        carry >>= 32;
+    }
+    if( carry && a->len < BIGLIMBS ) a->limb[a->len++] = (unsigned int) carry;
+}
+
+static void bigMulPow10( bigint_t *a, int n )
+{
+    for( ; n >= 9 ; n -= 9 ) bigMulAdd( a, 1000000000u, 0 );
+    if( n > 0 ) bigMulAdd( a, (unsigned int) pow10d[n], 0 );
+}
+
+static int bigBitLength( const bigint_t *a )
+{
+    unsigned int top;
+    int bits;
+
+    if( a->len == 0 ) return(0);
+    for( top = a->limb[a->len - 1], bits = 0 ; top ; top >>= 1 ) bits++;
+    return( (a->len - 1) * 32 + bits );
+}
+
+static void bigShiftLeft( bigint_t *a, int n )
+{
+    int words = n / 32, bits = n % 32;
+    int i;
+
+    if( a->len == 0 || n == 0 ) return;
+    if( a->len + words + 1 > BIGLIMBS ) words = BIGLIMBS - a->len - 1;   /* cannot happen for in-range input */
+
+    a->limb[a->len + words] = 0;
+    for( i = a->len - 1 ; i >= 0 ; i-- )
+    {
+        unsigned long long v = (unsigned long long) a->limb[i] << bits;
+        a->limb[i + words + 1] |= (unsigned int) (v >> 32);
+        a->limb[i + words] = (unsigned int) v;
+    }
+    for( i = 0 ; i < words ; i++ ) a->limb[i] = 0;
+    a->len += words + 1;
+    while( a->len > 0 && a->limb[a->len - 1] == 0 ) a->len--;
+}
+
+static void bigShiftRight1( bigint_t *a )
+{
+    int i;
+
+    for( i = 0 ; i < a->len ; i++ )
+    {
+        a->limb[i] >>= 1;
+        if( i + 1 < a->len ) a->limb[i] |= a->limb[i + 1] << 31;
+    }
+    while( a->len > 0 && a->limb[a->len - 1] == 0 ) a->len--;
+}
+
+static int bigCompare( const bigint_t *a, const bigint_t *b )
+{
+    int i;
+
+    if( a->len != b->len ) return( a->len < b->len ? -1 : 1 );
+    for( i = a->len - 1 ; i >= 0 ; i-- )
+    {
+        if( a->limb[i] != b->limb[i] ) return( a->limb[i] < b->limb[i] ? -1 : 1 );
+    }
+    return(0);
+}
+
+/* a -= b, with a >= b */
+static void bigSub( bigint_t *a, const bigint_t *b )
+{
+    long long borrow = 0;
+    int i;
+
+    for( i = 0 ; i < a->len ; i++ )
+    {
+        long long v = (long long) a->limb[i] - (i < b->len ? b->limb[i] : 0) - borrow;
+        borrow = v < 0;
+        a->limb[i] = (unsigned int) (v + (borrow << 32));
+    }
+    while( a->len > 0 && a->limb[a->len - 1] == 0 ) a->len--;
+}
+
+/* Round digits * 10^exp10 to mant * 2^exp2 with mant < 2^mantBits. minExp is the
+    exponent of the smallest subnormal, maxExp the largest exponent of a finite value */
+static void decToBin( const decimal_t *dec, int mantBits, int minExp, int maxExp, unsigned long long *pMant, int *pExp2 )
+{
+    static const int log2of10x1000 = 3322;
+    bigint_t num, den, d;
+    unsigned long long q, low, half;
+    int s, extra, bit, sticky, i;
+
+    /* far outside the range: no need for big numbers */
+    if( (dec->ndigits + dec->exp10 - 1) * log2of10x1000 / 1000 > maxExp + mantBits + 1 )
+    {
+        *pMant = 1;
+        *pExp2 = maxExp + mantBits + 2;    /* ldexp overflows to infinity */
+        return;
+    }
+    if( (dec->ndigits + dec->exp10 + 1) * log2of10x1000 / 1000 < minExp - 2 )
+    {
+        *pMant = 0;
+        *pExp2 = 0;
+        return;
+    }
+
+    bigSetSmall( &num, 0 );
+    for( i = 0 ; i < dec->ndigits ; i++ ) bigMulAdd( &num, 10, (unsigned int) (dec->digits[i] - '0') );
+    bigSetSmall( &den, 1 );
+    if( dec->exp10 >= 0 ) bigMulPow10( &num, dec->exp10 );
+    else bigMulPow10( &den, -dec->exp10 );
+
+    /* value = num/den. Find s so that num * 2^s / den has exactly mantBits+1 bits */
+    s = mantBits + 1 - (bigBitLength( &num ) - bigBitLength( &den ));
+    for( ;; )
+    {
+        bigint_t n = num, m = den;
+
+        if( s > 0 ) bigShiftLeft( &n, s );
+        else if( s < 0 ) bigShiftLeft( &m, -s );
+
+        /* q = n / m by shift and subtract; q has at most mantBits+2 bits */
+        d = m;
+        bigShiftLeft( &d, mantBits + 1 );
+        for( q = 0, bit = mantBits + 1 ; bit >= 0 ; bit-- )
+        {
+            if( bigCompare( &n, &d ) >= 0 )
+            {
+                bigSub( &n, &d );
+                q |= 1ULL << bit;
+            }
+            bigShiftRight1( &d );
+        }
+
+        if( q >= (1ULL << (mantBits + 1)) ) { s--; continue; }
+        if( q < (1ULL << mantBits) ) { s++; continue; }
+
+        sticky = n.len != 0;
+        break;
+    }
+
+    /* q carries one rounding bit; more when the result is subnormal */
+    extra = 1;
+    if( 1 - s < minExp ) extra += minExp - (1 - s);
+    if( extra > mantBits + 2 )
+    {
+        *pMant = 0;
+        *pExp2 = 0;
+        return;
+    }
+
+    low = q & ((1ULL << extra) - 1);
+    half = 1ULL << (extra - 1);
+    q >>= extra;
+    if( low > half || (low == half && (sticky || (q & 1))) ) q++;
+
+    *pMant = q;
+    *pExp2 = extra - s;
+}
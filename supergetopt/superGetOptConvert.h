@@ -0,0 +1,60 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+/* internal: the number conversions superGetOpt uses. Each returns 0 or -1 */
+
+#ifndef __SUPERGETOPT_CONVERT
+#define __SUPERGETOPT_CONVERT
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// decimal integer in [min, max]
+int sgConvSigned( const char *s, long long min, long long max, long long *pVal );
+
+// unsigned base 10 or 16 (optional 0x) integer no larger than max
+int sgConvUnsigned( const char *s, int base, unsigned long long max, unsigned long long *pVal );
+
+// correctly rounded decimal floating point, '.' as the radix whatever the locale. A finite
+// value that rounds past the largest of the type is out of range; inf and nan spelled out are not
+int sgConvDouble( const char *s, double *pVal );
+int sgConvFloat( const char *s, float *pVal );
+
+// byte size: a decimal number with an optional K M G T P E (powers of 1000) or Ki Mi .. Ei
+// (powers of 1024) and an optional B, like 4G, 1.5Mi or 64KiB. Fractions round down
+int sgConvSize( const char *s, unsigned long long *pVal );
+
+// duration in nanoseconds: [+-] and one or more numbers each with a unit ns us ms s m h d,
+// like 250ms or 1h30m. A bare 0 needs no unit. Fractions round toward zero
+int sgConvDuration( const char *s, long long *pVal );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
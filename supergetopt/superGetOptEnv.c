@@ -0,0 +1,226 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* Environment fallback: with a prefix set, a parse takes each option argv
+    didn't give from the variable named after it (MYTOOL_THREADS for -threads
+    under prefix "MYTOOL_"). environ is read once: the derived names go in a
+    hash, and each variable starting with the prefix is looked up there, so
+    there is no getenv() scan of the whole environment per option. Values
+    convert through the parser as argv does. A flag is set by any value but
+    "" and "0", a single %s takes the whole value, and other values are split
+    at blanks. A single value is used where it is in environ, so a %s points
+    there as it would into argv; split values are copies in the context,
+    kept until its next parse.
+*/
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "supergetopt.h"
+#include "superGetOptInt.h"
+
+#ifdef _WIN32
+#define environ _environ
+#else
+extern char **environ;
+#endif
+
+#define ENV_FIRST_SLOTS 64   /* hash slots, first allocation; always a power of 2 */
+
+static unsigned int hashKey( const char *s, size_t len )
+{
+    unsigned int h = 2166136261u;
+    size_t k;
+
+    for( k = 0 ; k < len ; k++ ) h = (h ^ (unsigned char) s[k]) * 16777619u;
+    return( h );
+}
+
+/* prefix, then the name without its leading '-'s in upper case, '_' for anything not alphanumeric */
+static char *deriveName( sgArena_t *arena, const char *prefix, size_t pfxLen, const char *name )
+{
+    char *d, *p;
+
+    while( *name == '-' || *name == '+' || *name == '=' ) name++;
+    d = (char *) sgArenaAlloc( arena, pfxLen + strlen( name ) + 1 );
+    if( d == NULL ) return( NULL );
+
+    memcpy( d, prefix, pfxLen );
+    for( p = d + pfxLen ; *name ; name++ )
+    {
+        *p++ = isalnum( (unsigned char) *name ) ? (char) toupper( (unsigned char) *name ) : '_';
+    }
+    *p = 0;
+    return( d );
+}
+
+/* names[i] is option i's variable; two options deriving the same name leave it to the first */
+static int buildIndex( sgEnv_t *env, const superOptSpec_t *spec, char **names, size_t pfxLen )
+{
+    int numOpts = sgNumOptions( spec );
+    int size = ENV_FIRST_SLOTS;
+    unsigned int mask, h;
+    int i;
+
+    while( size < 2 * numOpts ) size *= 2;
+    if( env->slotsCap < size )
+    {
+        int *slots = (int *) realloc( env->slots, size * sizeof(int) );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( slots == NULL ) return( SG_ERROR_NO_MEMORY );
+        env->slots = slots;
+        env->slotsCap = size;
+    }
+    memset( env->slots, 0, env->slotsCap * sizeof(int) );
+    mask = (unsigned int) env->slotsCap - 1;
+
+    for( i = 0 ; i < numOpts ; i++ )
+    {
+        names[i] = deriveName( &env->strings, env->prefix, pfxLen, sgOptionName( spec, i ) );
+        if( names[i] == NULL ) return( SG_ERROR_NO_MEMORY );
+
+        for( h = hashKey( names[i], strlen( names[i] ) ) & mask ; env->slots[h] != 0 ; h = (h + 1) & mask )
+        {
+            if( strcmp( names[env->slots[h] - 1], names[i] ) == 0 ) break;
+        }
+        if( env->slots[h] == 0 ) env->slots[h] = i + 1;
+    }
+    return(0);
+}
+
+/* the option whose variable is key[0..len), or -1 */
+static int findVar( const sgEnv_t *env, char **names, const char *key, size_t len )
+{
+    unsigned int mask = (unsigned int) env->slotsCap - 1;
+    unsigned int h;
+
+    for( h = hashKey( key, len ) & mask ; env->slots[h] != 0 ; h = (h + 1) & mask )
+    {
+        const char *name = names[env->slots[h] - 1];
+
+        if( strncmp( name, key, len ) == 0 && name[len] == 0 ) return( env->slots[h] - 1 );
+    }
+    return(-1);
+}
+
+/* parse "name value..." for option opt, as if it were on argv. Errors name the variable */
+static int applyValue( superOptCtx_t *ctx, sgEnv_t *env, const superOptSpec_t *spec, int opt, const char *var, const char *value )
+{
+    char **args;
+    char *copy, *p;
+    int numargs, varflag, argc = 1, k, n, lastArg;
+
+    numargs = sgOptionArgs( spec, opt, &varflag );
+    if( numargs == 0 && varflag != 1 && (value[0] == 0 || strcmp( value, "0" ) == 0) ) return(0);
+
+    /* a batch worker's copies go with it: split %s values can't outlive the batch */
+    if( (numargs > 1 || varflag == 1) && sgCtxInBatch( ctx ) && sgOptionHasString( spec, opt ) )
+    {
+        n = sgCtxSetDiag( ctx, SG_ERROR_BAD_BINDING, 0, sgOptionName( spec, opt ), -1, NULL );
+        sgCtxDiag( ctx )->source = var;
+        return(n);
+    }
+
+    copy = numargs == 1 && varflag != 1 ? (char *) value : sgArenaStrdup( &env->strings, value );
+    args = (char **) sgArenaAlloc( &env->strings, (strlen( value ) / 2 + 2) * sizeof(char *) );
+    if( copy == NULL || args == NULL ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+
+    args[0] = (char *) sgOptionName( spec, opt );
+    if( numargs == 1 && varflag != 1 ) args[argc++] = copy;     /* parsed in place: not changed */
+    else if( numargs > 0 || varflag == 1 )
+    {
+        for( p = copy ; ; )
+        {
+            while( isspace( (unsigned char) *p ) ) p++;
+            if( *p == 0 ) break;
+            args[argc++] = p;
+            while( *p && !isspace( (unsigned char) *p ) ) p++;
+            if( *p ) *p++ = 0;
+        }
+    }
+
+    /* every word is a value: nothing may be left over or taken for another option */
+    n = 0;
+    if( varflag != 1 && argc - 1 > numargs ) n = sgCtxSetDiag( ctx, SG_ERROR_INCORRECT_ARG, 0, args[0], -1, args[numargs + 1] );
+    for( k = 1 ; k < argc && varflag == 1 && n == 0 ; k++ )
+    {
+        if( sgIsOption( ctx, spec, args[k] ) ) n = sgCtxSetDiag( ctx, SG_ERROR_INCORRECT_ARG, 0, args[0], -1, args[k] );
+    }
+    if( n == 0 ) n = sgParseOption( ctx, spec, opt, 0, argc, args, &lastArg );
+
+    if( n < 0 )
+    {
+        sgCtxDiag( ctx )->argIndex = 0;
+        sgCtxDiag( ctx )->source = var;
+    }
+    return( n < 0 ? n : 0 );
+}
+
+int sgEnvApply( superOptCtx_t *ctx, sgEnv_t *env, const superOptSpec_t *spec )
+{
+    char **names, **e;
+    const char *eq;
+    size_t pfxLen;
+    int opt, n;
+
+    if( env->prefix == NULL || sgNumOptions( spec ) == 0 ) return(0);
+
+    sgArenaReset( &env->strings );
+    pfxLen = strlen( env->prefix );
+    names = (char **) sgArenaAlloc( &env->strings, sgNumOptions( spec ) * sizeof(char *) );
+    if( names == NULL || buildIndex( env, spec, names, pfxLen ) < 0 ) return( sgCtxSetDiag( ctx, SG_ERROR_NO_MEMORY, 0, NULL, -1, NULL ) );
+
+    for( e = environ ; e != NULL && *e != NULL ; e++ )
+    {
+        if( strncmp( *e, env->prefix, pfxLen ) != 0 || (eq = strchr( *e + pfxLen, '=' )) == NULL ) continue;
+
+        opt = findVar( env, names, *e, (size_t) (eq - *e) );
+        if( opt < 0 || (opt < env->seenCap && env->seen[opt]) ) continue;     /* argv wins */
+
+        n = applyValue( ctx, env, spec, opt, names[opt], eq + 1 );
+        if( n < 0 ) return(n);
+    }
+    return(0);
+}
+
+void sgEnvRelease( sgEnv_t *env )
+{
+    free( env->seen );
+    free( env->slots );
+    sgArenaRelease( &env->strings );
+    env->seen = NULL;
+    env->seenCap = 0;
+    env->slots = NULL;
+    env->slotsCap = 0;
+}
@@ -0,0 +1,293 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* Config files: each line is "name value value ...", parsed with the same
+    compiled spec as the command line. The file is read in fixed size chunks
+    and parsed a line at a time, so memory stays at one chunk (or the longest
+    line, if longer) plus the string values kept, whatever the file size.
+
+    '#' at the start of a token comments out the rest of the line, a '\' at
+    the very end of a line continues it on the next, and quotes and escapes
+    work as in response files. A name matches an option as written or without
+    its leading '-' or "--", so "threads 8" sets "-threads %d".
+*/
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "supergetopt.h"
+#include "superGetOptInt.h"
+
+#define FILE_CHUNK 65536     /* bytes read at a time */
+
+typedef struct
+{
+    FILE *fp;
+    char *buf;
+    size_t cap;                 /* buf holds cap bytes plus a terminator */
+    size_t pos, len;            /* unparsed bytes are buf[pos..len) */
+    int eof;
+    char **argv;
+    int argvCap;
+    char *key;                  /* the name with a '-' or "--" put back */
+    size_t keyCap;
+} fileReader_t;
+
+static int isBlank( char c )
+{
+    return( c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' );
+}
+
+/* the end of the logical line starting at buf[pos]: its '\n', or len at the end of the data.
+    Returns 0 when the line isn't all in the buffer yet */
+static int findLineEnd( fileReader_t *r, size_t *pEnd )
+{
+    char *p = r->buf + r->pos;
+    char *end = r->buf + r->len;
+    char *nl;
+
+    while( (nl = (char *) memchr( p, '\n', (size_t) (end - p) )) != NULL )
+    {
+        char *q = nl;
+
+        if( q > p && q[-1] == '\r' ) q--;
+        if( q == p || q[-1] != '\\' )
+        {
+            *pEnd = (size_t) (nl - r->buf);
+            return(1);
+        }
+        p = nl + 1;     /* continued */
+    }
+
+    if( !r->eof ) return(0);
+    *pEnd = r->len;
+    return(1);
+}
+
+/* keep the unparsed tail, make room, read the next chunk */
+static int fillBuffer( fileReader_t *r )
+{
+    size_t n;
+
+    if( r->pos > 0 )
+    {
+        memmove( r->buf, r->buf + r->pos, r->len - r->pos );
+        r->len -= r->pos;
+        r->pos = 0;
+    }
+    if( r->len == r->cap )      /* one line longer than the buffer */
+    {
+        char *buf = (char *) realloc( r->buf, 2 * r->cap + 1 );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( buf == NULL ) return( SG_ERROR_NO_MEMORY );
+        r->buf = buf;
+        r->cap *= 2;
+    }
+
+    n = fread( r->buf + r->len, 1, r->cap - r->len, r->fp );
+    r->len += n;
+    if( n == 0 ) r->eof = 1;
+    return(0);
+}
+
+/* split buf[p..end) into tokens in place. Returns the number of tokens, or <0 */
+static int tokenizeLine( fileReader_t *r, char *p, char *end )
+{
+    int argc = 0;
+    char *out;
+    int sq, dq;
+
+    for( ;; )
+    {
+        /* blanks and continuations separate tokens */
+        for( ;; )
+        {
+            if( p < end && (isBlank( *p ) || *p == '\n') ) p++;
+            else if( p + 1 < end && p[0] == '\\' && (p[1] == '\n' || (p[1] == '\r' && p + 2 < end && p[2] == '\n')) ) p += 2;
+            else break;
+        }
+        if( p >= end || *p == '#' ) break;
+
+        if( argc + 1 >= r->argvCap )
+        {
+            int cap = r->argvCap ? 2 * r->argvCap : 32;
+            char **argv = (char **) realloc( r->argv, cap * sizeof(char *) );
+            SG_STATS_ADD( allocs, 1 );
+
+            if( argv == NULL ) return( SG_ERROR_NO_MEMORY );
+            r->argv = argv;
+            r->argvCap = cap;
+        }
+        r->argv[argc++] = out = p;
+
+        sq = dq = 0;
+        while( p < end )
+        {
+            if( !sq && !dq && (isBlank( *p ) || *p == '\n') ) break;
+            if( *p == '\\' && !sq && p + 1 < end )
+            {
+                if( p[1] == '\n' ) { p += 2; continue; }                             /* continued mid token */
+                if( p[1] == '\r' && p + 2 < end && p[2] == '\n' ) { p += 3; continue; }
+                *out++ = p[1];
+                p += 2;
+            }
+            else if( *p == '\'' && !dq ) { sq = !sq; p++; }
+            else if( *p == '"' && !sq ) { dq = !dq; p++; }
+            else *out++ = *p++;
+        }
+        if( p < end ) p++;
+        *out = 0;           /* out < p, or out == end which is the line's terminator slot */
+    }
+
+    if( argc > 0 ) r->argv[argc] = NULL;
+    return( argc );
+}
+
+/* point argv[0] at the option it names, trying "-name" and "--name" as well */
+static int matchKey( fileReader_t *r, const superOptSpec_t *spec, char **argv )
+{
+    size_t len;
+    int dashes;
+
+    if( sgFindOption( spec, argv[0] ) >= 0 ) return(1);
+
+    len = strlen( argv[0] );
+    if( len + 3 > r->keyCap )
+    {
+        char *key = (char *) realloc( r->key, len + 3 );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( key == NULL ) return( SG_ERROR_NO_MEMORY );
+        r->key = key;
+        r->keyCap = len + 3;
+    }
+    for( dashes = 1 ; dashes <= 2 ; dashes++ )
+    {
+        memset( r->key, '-', (size_t) dashes );
+        memcpy( r->key + dashes, argv[0], len + 1 );
+        if( sgFindOption( spec, r->key ) >= 0 )
+        {
+            argv[0] = r->key;
+            return(1);
+        }
+    }
+    return(0);
+}
+
+static int parseStream( superOptCtx_t *ctx, const superOptSpec_t *spec, fileReader_t *r, int *lastLine )
+{
+    int line = 1, first = 1;
+    int argc, argPos, n, i;
+    size_t end;
+    char *p;
+
+    for( ;; )
+    {
+        while( !findLineEnd( r, &end ) )
+        {
+            n = fillBuffer( r );
+            if( n < 0 ) return(n);
+        }
+        if( r->pos == r->len && r->eof ) return(0);
+
+        *lastLine = line;
+        p = r->buf + r->pos;
+        for( i = 0 ; p + i < r->buf + end ; i++ ) if( p[i] == '\n' ) line++;    /* continuations */
+        line++;
+
+        r->buf[end] = 0;
+        argc = tokenizeLine( r, p, r->buf + end );
+        r->pos = (end < r->len) ? end + 1 : end;
+        if( argc < 0 ) return( argc );
+        if( argc == 0 ) continue;
+
+        n = matchKey( r, spec, r->argv );
+        if( n < 0 ) return(n);
+        if( n == 0 ) return( sgCtxSetDiag( ctx, SG_ERROR_UNKNOWN_ARG, *lastLine, NULL, -1, r->argv[0] ) );
+
+        n = sgParseLine( ctx, spec, argc, r->argv, first, &argPos );
+        first = 0;
+        if( n < 0 )
+        {
+            sgCtxDiag( ctx )->argIndex = *lastLine;     /* the parse counted within the line */
+            return(n);
+        }
+    }
+}
+
+int superCtxParseFile( superOptCtx_t *ctx, const superOptSpec_t *spec, const char *path, int *lastLine )
+{
+    fileReader_t r;
+    int lineDummy;
+    int n;
+
+    if( lastLine == NULL ) lastLine = &lineDummy;
+    *lastLine = 0;
+    if( ctx == NULL || spec == NULL || path == NULL ) return( SG_ERROR_MISSING_ARG );
+
+    sgCtxResetStrings( ctx );
+    sgCtxClearDiag( ctx );
+
+    memset( &r, 0, sizeof(r) );
+    r.fp = strcmp( path, "-" ) == 0 ? stdin : fopen( path, "rb" );
+    if( r.fp == NULL )
+    {
+        sgCtxSetDiag( ctx, SG_ERROR_MISSING_ARG, 0, NULL, -1, NULL );
+        sgCtxDiag( ctx )->source = path;
+        sgCtxReportDiag( ctx );
+        return( SG_ERROR_MISSING_ARG );
+    }
+
+    r.cap = FILE_CHUNK;
+    r.buf = (char *) malloc( r.cap + 1 );
+    SG_STATS_ADD( allocs, 1 );
+    n = (r.buf == NULL) ? SG_ERROR_NO_MEMORY : parseStream( ctx, spec, &r, lastLine );
+    if( n == 0 ) *lastLine = 0;
+    else
+    {
+        if( sgCtxDiag( ctx )->code == 0 ) sgCtxSetDiag( ctx, n, *lastLine, NULL, -1, NULL );
+        sgCtxDiag( ctx )->source = path;
+    }
+    sgCtxReportDiag( ctx );
+
+    if( r.fp != stdin ) fclose( r.fp );
+    free( r.buf );
+    free( r.argv );
+    free( r.key );
+    return(n);
+}
+
+int superParseFile( const superOptSpec_t *spec, const char *path, int *lastLine )
+{
+    return( superCtxParseFile( sgThreadCtx(), spec, path, lastLine ) );
+}
@@ -0,0 +1,183 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* internal: what the other superGetOpt modules need from the core parser */
+
+#ifndef __SUPERGETOPT_INT
+#define __SUPERGETOPT_INT
+
+#include "supergetopt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// redirect a context's writes: spec pointers in [bindBase, bindBase+bindSize) land at the
+// same offset from outBase. outBase NULL writes through the spec pointers as bound
+void sgCtxSetOutput( superOptCtx_t *ctx, const void *bindBase, size_t bindSize, void *outBase );
+
+// 1 if every pointer the spec writes through lies in [base, base+size)
+int sgSpecBoundWithin( const superOptSpec_t *spec, const void *base, size_t size );
+
+// 1 while a batch is redirecting the context's writes
+int sgCtxInBatch( const superOptCtx_t *ctx );
+
+// give ctx the modes of from (names, extras, diagnostics, environment prefix), for a batch
+// worker, lazy handle or watch. The string mode stays as it is: a worker's copies would go with
+// its context
+void sgCtxCopyModes( superOptCtx_t *ctx, const superOptCtx_t *from );
+
+// a bump allocator: allocations live until sgArenaReset (which keeps the newest block for
+// reuse) or sgArenaRelease. A zeroed sgArena_t is an empty arena
+typedef struct sgArenaBlock_s sgArenaBlock_t;
+
+typedef struct
+{
+    sgArenaBlock_t *head;       /* block being filled; older blocks follow */
+    size_t used;
+} sgArena_t;
+
+void *sgArenaAlloc( sgArena_t *arena, size_t size );
+// make room in one block for count allocations totalling size bytes, so they malloc nothing
+void sgArenaReserve( sgArena_t *arena, size_t size, int count );
+char *sgArenaStrdup( sgArena_t *arena, const char *s );
+void sgArenaReset( sgArena_t *arena );
+void sgArenaRelease( sgArena_t *arena );
+
+// config files: parse one line's tokens. String values are copied into the context
+// (they live until sgCtxResetStrings) and var counts are only reset when first is set
+int sgParseLine( superOptCtx_t *ctx, const superOptSpec_t *spec, int argc, char **argv, int first, int *lastArg );
+
+// a new parse: the context's string copies are dropped (their memory kept for reuse),
+// unless it is in SG_STRINGS_KEEP
+void sgCtxResetStrings( superOptCtx_t *ctx );
+
+// the context superGetOpt and friends use on this thread
+superOptCtx_t *sgThreadCtx( void );
+
+// the option number name matches, or -1
+int sgFindOption( const superOptSpec_t *spec, const char *name );
+
+// the same with ctx's name mode: in prefix mode a unique start of a name matches too, and the
+// start of several is SG_ERROR_AMBIGUOUS_ARG
+int sgCtxFindOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, const char *name );
+int sgNumOptions( const superOptSpec_t *spec );
+
+// 1 if s would be taken for an option where a value could go: a name, or with ctx's name mode a
+// prefix of one, or a "--name=value" or bundle
+int sgIsOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, char *s );
+
+// the option of "--name=value" or "-nvalue", s naming it and its first value in one arg, or -1
+// (a bundle of flags is -1 too), or SG_ERROR_AMBIGUOUS_ARG as for sgCtxFindOption
+int sgAttachedOption( const superOptCtx_t *ctx, const superOptSpec_t *spec, char *s );
+
+// option opt's arg count (0 for a flag) and whether it takes a * list
+int sgOptionArgs( const superOptSpec_t *spec, int opt, int *varflag );
+
+// 1 if any of option opt's values is a %s
+int sgOptionHasString( const superOptSpec_t *spec, int opt );
+
+const char *sgOptionName( const superOptSpec_t *spec, int opt );
+
+// an option's current values packed into buf, to compare or put back: returns the size, and
+// only writes when it fits in cap. sgRestoreOption sets them back; strings then point into buf,
+// or with raw set were saved as their pointers and point where they did
+size_t sgSaveOption( const superOptSpec_t *spec, int opt, char *buf, size_t cap, int raw );
+void sgRestoreOption( const superOptSpec_t *spec, int opt, char *buf );
+
+// lazy handles: parse argv[0..argc-1], one occurrence of option opt and its values, leaving the
+// other options' var counts alone. first resets opt's own count (argc 0 does only that)
+int sgParseOption( superOptCtx_t *ctx, const superOptSpec_t *spec, int opt, int first, int argc, char **argv, int *lastArg );
+
+// diagnostics: a public entry point clears them, the parse records what ended it (returning
+// code), and the entry point reports them on the way out, printing only in SG_DIAG_STDERR
+void sgCtxClearDiag( superOptCtx_t *ctx );
+int sgCtxSetDiag( superOptCtx_t *ctx, int code, int argIndex, const char *option, int type, const char *token );
+superDiag_t *sgCtxDiag( superOptCtx_t *ctx );
+int sgCtxDiagMode( const superOptCtx_t *ctx );
+void sgCtxReportDiag( const superOptCtx_t *ctx );
+
+// response files (@file): the mapped files and the expanded argv of one context
+typedef struct
+{
+    void *addr;
+    size_t len;                 /* 0: addr is a malloc'd block */
+} sgRspBlock_t;
+
+typedef struct
+{
+    char **argv;                /* expanded vector, NULL if nothing was expanded */
+    int argc;
+    int argvCap;
+    sgRspBlock_t *blocks;
+    int numBlocks;
+    int blocksCap;
+} sgRsp_t;
+
+// expand @file arguments of argv[keep..argc-1]. Without any, *pArgv is argv itself.
+// Tokens point into the mapped files and stay valid until sgRspRelease.
+// Returns 0 or an SG_ERROR_* code, with *pBadArg the offending index of argv
+int sgRspExpand( sgRsp_t *rsp, int argc, char **argv, int keep, int *pArgc, char ***pArgv, int *pBadArg );
+void sgRspRelease( sgRsp_t *rsp );
+
+// environment fallback: after a parse, options argv didn't give are taken from variables named
+// prefix plus the option name (upper case, '-' as '_', leading '-'s dropped)
+typedef struct
+{
+    const char *prefix;         /* NULL: off */
+    unsigned char *seen;        /* per option: given on argv, marked by the parse */
+    int seenCap;
+    int *slots;                 /* derived name hash: option number + 1, 0 for empty */
+    int slotsCap;
+    sgArena_t strings;          /* derived names, and values split into args */
+} sgEnv_t;
+
+// apply the environment to what spec didn't get from argv. Values live until the next call.
+// Returns 0 or an SG_ERROR_* code, with the variable in the context's diag
+int sgEnvApply( superOptCtx_t *ctx, sgEnv_t *env, const superOptSpec_t *spec );
+void sgEnvRelease( sgEnv_t *env );
+
+// instrumentation: with SG_ENABLE_STATS off these compile to nothing
+#if SG_ENABLE_STATS
+extern superOptStats_t sgStats;
+unsigned long long sgStatsNow( void );
+void sgStatsAdd( unsigned long long *counter, unsigned long long n );
+#define SG_STATS_ADD( field, n )    sgStatsAdd( &sgStats.field, (n) )
+#define SG_STATS_START( t )         unsigned long long t = sgStatsNow()
+#define SG_STATS_STOP( field, t )   sgStatsAdd( &sgStats.field, sgStatsNow() - (t) )
+#else
+#define SG_STATS_ADD( field, n )
+#define SG_STATS_START( t )
+#define SG_STATS_STOP( field, t )
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,302 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* Lazy parsing: superParseLazy only works out which argv slots belong to
+    which option, converting nothing. superLazyGet converts one option's values
+    into its variables the first time it is asked for, through the same parser
+    as superParseSpec (so with the same checks and errors), and keeps the
+    result. A run that reads a few of many options only pays for those few.
+*/
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "supergetopt.h"
+#include "superGetOptInt.h"
+
+#define FIRST_OCCS 16       /* occurrences and extra spans, first allocation */
+
+typedef struct
+{
+    int start;                  /* argv index of the option name */
+    int count;                  /* the name and its values */
+    int attached;               /* the name slot holds the first value, "--name=value" */
+    int next;                   /* the option's next occurrence, -1 at the last */
+} lazyOcc_t;
+
+typedef struct
+{
+    int first, last;            /* occurrences, -1 if never given */
+    int done;                   /* converted: result and errArg are the outcome */
+    int result;
+    int errArg;
+} lazyOpt_t;
+
+struct superLazy_s
+{
+    const superOptSpec_t *spec;
+    superOptCtx_t *ctx;         /* parse state for the conversions */
+    int argc;
+    char **argv;
+    lazyOpt_t *opts;            /* one per option of the spec */
+    lazyOcc_t *occs;
+    int numOccs;
+    int occsCap;
+    superArgSpan_t *extras;
+    int numSpans;
+    int spansCap;
+    int numExtras;
+};
+
+static int addOccurrence( superLazy_t *lazy, int opt, int start, int count, int attached )
+{
+    lazyOpt_t *o = &lazy->opts[opt];
+    lazyOcc_t *occ;
+
+    if( lazy->numOccs == lazy->occsCap )
+    {
+        int cap = lazy->occsCap ? 2 * lazy->occsCap : FIRST_OCCS;
+        lazyOcc_t *list = (lazyOcc_t *) realloc( lazy->occs, cap * sizeof(lazyOcc_t) );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( list == NULL ) return( SG_ERROR_NO_MEMORY );
+        lazy->occs = list;
+        lazy->occsCap = cap;
+    }
+
+    occ = &lazy->occs[lazy->numOccs];
+    occ->start = start;
+    occ->count = count;
+    occ->attached = attached;
+    occ->next = -1;
+    if( o->last >= 0 ) lazy->occs[o->last].next = lazy->numOccs;
+    else o->first = lazy->numOccs;
+    o->last = lazy->numOccs++;
+    return(0);
+}
+
+/* argv[a] belongs to no option: extend the last span or start one. Positions are 1-based */
+static int addExtra( superLazy_t *lazy, int a )
+{
+    superArgSpan_t *last = lazy->numSpans ? &lazy->extras[lazy->numSpans-1] : NULL;
+
+    lazy->numExtras++;
+    if( last != NULL && last->start + last->count == a + 1 )
+    {
+        last->count++;
+        return(0);
+    }
+
+    if( lazy->numSpans == lazy->spansCap )
+    {
+        int cap = lazy->spansCap ? 2 * lazy->spansCap : FIRST_OCCS;
+        superArgSpan_t *list = (superArgSpan_t *) realloc( lazy->extras, cap * sizeof(superArgSpan_t) );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( list == NULL ) return( SG_ERROR_NO_MEMORY );
+        lazy->extras = list;
+        lazy->spansCap = cap;
+    }
+    lazy->extras[lazy->numSpans].start = a + 1;
+    lazy->extras[lazy->numSpans].count = 1;
+    lazy->numSpans++;
+    return(0);
+}
+
+/* which slots go with which option: a * list runs to the next arg that would be taken for an
+    option, a fixed option takes its count of args whatever they hold. "--name=value" is one
+    slot for the name and first value; bundles of one character options are not split */
+static int splitArgs( superLazy_t *lazy, int *lastArg )
+{
+    const superOptSpec_t *spec = lazy->spec;
+    char **argv = lazy->argv;
+    int argc = lazy->argc;
+    int a, i, k, n, numargs, varflag, attached;
+
+    for( a = 0 ; a < argc ; a += k )
+    {
+        i = sgCtxFindOption( lazy->ctx, spec, argv[a] );
+        attached = 0;
+        if( i == -1 && (i = sgAttachedOption( lazy->ctx, spec, argv[a] )) >= 0 ) attached = 1;
+        if( i == SG_ERROR_AMBIGUOUS_ARG )
+        {
+            *lastArg = a + 1;
+            return( sgCtxSetDiag( lazy->ctx, SG_ERROR_AMBIGUOUS_ARG, a + 1, NULL, -1, argv[a] ) );
+        }
+        if( i < 0 )
+        {
+            k = 1;
+            if( argv[a][0] == '-' || argv[a][0] == '+' || argv[a][0] == '=' )
+            {
+                *lastArg = a + 1;
+                return( sgCtxSetDiag( lazy->ctx, SG_ERROR_UNKNOWN_ARG, a + 1, NULL, -1, argv[a] ) );
+            }
+            n = addExtra( lazy, a );
+            if( n < 0 ) return(n);
+            continue;
+        }
+
+        numargs = sgOptionArgs( spec, i, &varflag );
+        if( varflag == 1 )
+        {
+            for( k = 1 ; a + k < argc && !sgIsOption( lazy->ctx, spec, argv[a+k] ) ; k++ );
+        }
+        else
+        {
+            /* a flag given a value still takes just its slot: the conversion says it's wrong */
+            k = numargs > attached ? 1 + numargs - attached : 1;
+            if( a + k > argc )
+            {
+                *lastArg = argc + 1;
+                return( sgCtxSetDiag( lazy->ctx, SG_ERROR_MISSING_ARG, argc + 1, sgOptionName( spec, i ), -1, NULL ) );
+            }
+        }
+
+        n = addOccurrence( lazy, i, a, k, attached );
+        if( n < 0 ) return(n);
+    }
+
+    *lastArg = lazy->numSpans ? lazy->extras[0].start : 0;
+    return( lazy->numExtras );
+}
+
+const superDiag_t *superLazyDiag( const superLazy_t *lazy )
+{
+    return( lazy ? superCtxLastDiag( lazy->ctx ) : NULL );
+}
+
+void superFreeLazy( superLazy_t *lazy )
+{
+    if( lazy == NULL ) return;
+
+    superCtxFree( lazy->ctx );
+    free( lazy->opts );
+    free( lazy->occs );
+    free( lazy->extras );
+    free( lazy );
+}
+
+int superParseLazy( const superOptSpec_t *spec, int argc, char **argv, int *lastArg, superLazy_t **pLazy )
+{
+    superOptCtx_t *threadCtx = sgThreadCtx();
+    superLazy_t *lazy;
+    int argDummy;
+    int i, n;
+
+    if( lastArg == NULL ) lastArg = &argDummy;
+    *lastArg = 0;
+    if( pLazy == NULL || spec == NULL ) return( SG_ERROR_MISSING_ARG );
+    *pLazy = NULL;
+    if( argv == NULL ) argc = 0;
+
+    lazy = (superLazy_t *) calloc( 1, sizeof(superLazy_t) );
+    SG_STATS_ADD( allocs, 1 );
+    if( lazy == NULL ) return( SG_ERROR_NO_MEMORY );
+
+    lazy->spec = spec;
+    lazy->argc = argc;
+    lazy->argv = argv;
+    lazy->ctx = superCtxNew();
+    lazy->opts = (lazyOpt_t *) malloc( (sgNumOptions( spec ) + 1) * sizeof(lazyOpt_t) );
+    SG_STATS_ADD( allocs, 1 );
+    if( lazy->ctx == NULL || lazy->opts == NULL )
+    {
+        superFreeLazy( lazy );
+        return( SG_ERROR_NO_MEMORY );
+    }
+    if( threadCtx != NULL ) sgCtxCopyModes( lazy->ctx, threadCtx );
+    for( i = 0 ; i < sgNumOptions( spec ) ; i++ )
+    {
+        lazy->opts[i].first = lazy->opts[i].last = -1;
+        lazy->opts[i].done = 0;
+    }
+
+    n = splitArgs( lazy, lastArg );
+    if( n < 0 )
+    {
+        /* there is no handle to ask: the diagnostics go to the thread's context */
+        sgCtxReportDiag( lazy->ctx );
+        if( threadCtx != NULL ) *sgCtxDiag( threadCtx ) = *sgCtxDiag( lazy->ctx );
+        superFreeLazy( lazy );
+        return(n);
+    }
+
+    *pLazy = lazy;
+    return(n);
+}
+
+int superLazyGet( superLazy_t *lazy, const char *name, int *lastArg )
+{
+    const lazyOcc_t *occ;
+    lazyOpt_t *o;
+    int argDummy;
+    int i, k, n, numargs, varflag, count = 0;
+
+    if( lastArg == NULL ) lastArg = &argDummy;
+    *lastArg = 0;
+    if( lazy == NULL || name == NULL ) return( SG_ERROR_MISSING_ARG );
+
+    i = sgCtxFindOption( lazy->ctx, lazy->spec, name );
+    if( i < 0 ) return( i == SG_ERROR_AMBIGUOUS_ARG ? i : SG_ERROR_UNKNOWN_ARG );
+    o = &lazy->opts[i];
+
+    if( !o->done )
+    {
+        numargs = sgOptionArgs( lazy->spec, i, &varflag );
+        sgCtxClearDiag( lazy->ctx );
+        n = sgParseOption( lazy->ctx, lazy->spec, i, 1, 0, NULL, lastArg );
+        for( k = o->first ; k >= 0 && n >= 0 ; k = occ->next )
+        {
+            occ = &lazy->occs[k];
+            n = sgParseOption( lazy->ctx, lazy->spec, i, 0, occ->count, lazy->argv + occ->start, lastArg );
+            if( n < 0 )
+            {
+                *lastArg += occ->start;
+                sgCtxDiag( lazy->ctx )->argIndex += occ->start;
+            }
+            count += varflag == 1 ? (occ->count - 1 + occ->attached) / numargs : (numargs > 0 ? numargs : 1);
+        }
+        o->done = 1;
+        o->result = n < 0 ? n : count;
+        o->errArg = n < 0 ? *lastArg : 0;
+        sgCtxReportDiag( lazy->ctx );
+    }
+
+    *lastArg = o->errArg;
+    return( o->result );
+}
+
+const superArgSpan_t *superLazyExtraSpans( const superLazy_t *lazy, int *numSpans )
+{
+    if( numSpans ) *numSpans = lazy ? lazy->numSpans : 0;
+    return( lazy ? lazy->extras : NULL );
+}
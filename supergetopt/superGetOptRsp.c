@@ -0,0 +1,332 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* Response files: an argument @name is replaced by the arguments in file name.
+    The file is mapped privately and tokenized where it lies: quotes and
+    backslash escapes are collapsed in place and each token is terminated
+    over its trailing separator, so argv points straight into the mapping.
+    Nested @files are expanded too; a file that includes itself is an error.
+    An @name that cannot be read is kept as a plain argument.
+*/
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "supergetopt.h"
+#include "superGetOptInt.h"
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define RSP_MAX_DEPTH 32     /* nesting limit, and the size of the cycle check stack */
+
+typedef struct
+{
+#ifndef _WIN32
+    dev_t dev;
+    ino_t ino;
+#else
+    const char *name;
+#endif
+} rspId_t;
+
+typedef struct
+{
+    sgRsp_t *rsp;
+    rspId_t open[RSP_MAX_DEPTH];   /* files being expanded, outermost first */
+    int depth;
+} rspWalk_t;
+
+static int pushArg( sgRsp_t *rsp, char *arg )
+{
+    if( rsp->argc + 1 >= rsp->argvCap )      /* room for the NULL terminator too */
+    {
+        int cap = rsp->argvCap ? 2 * rsp->argvCap : 64;
+        char **argv = (char **) realloc( rsp->argv, cap * sizeof(char *) );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( argv == NULL ) return( SG_ERROR_NO_MEMORY );
+        rsp->argv = argv;
+        rsp->argvCap = cap;
+    }
+    rsp->argv[rsp->argc++] = arg;
+    rsp->argv[rsp->argc] = NULL;
+    return(0);
+}
+
+static int pushBlock( sgRsp_t *rsp, void *addr, size_t len )
+{
+    if( rsp->numBlocks == rsp->blocksCap )
+    {
+        int cap = rsp->blocksCap ? 2 * rsp->blocksCap : 8;
+        sgRspBlock_t *blocks = (sgRspBlock_t *) realloc( rsp->blocks, cap * sizeof(sgRspBlock_t) );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( blocks == NULL ) return( SG_ERROR_NO_MEMORY );
+        rsp->blocks = blocks;
+        rsp->blocksCap = cap;
+    }
+    rsp->blocks[rsp->numBlocks].addr = addr;
+    rsp->blocks[rsp->numBlocks].len = len;
+    rsp->numBlocks++;
+    return(0);
+}
+
+static void freeBlock( sgRspBlock_t *b )
+{
+#ifndef _WIN32
+    if( b->len ) { munmap( b->addr, b->len ); return; }
+#endif
+    free( b->addr );
+}
+
+/* the file's contents, writable and private. *pTail is 1 when a byte past the end may be
+    written (it is zero); 0 when the contents end exactly at the end of the mapping.
+    Returns 1 on success, 0 when the file cannot be read, <0 on errors */
+static int loadFile( rspWalk_t *w, const char *name, rspId_t *id, char **pData, size_t *pSize, int *pTail )
+{
+#ifndef _WIN32
+    struct stat st;
+    size_t page = (size_t) sysconf( _SC_PAGESIZE );
+    void *addr;
+    int fd = open( name, O_RDONLY );
+
+    if( fd < 0 ) return(0);
+    if( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) ) { close( fd ); return(0); }
+
+    id->dev = st.st_dev;
+    id->ino = st.st_ino;
+    *pSize = (size_t) st.st_size;
+
+    if( *pSize == 0 )
+    {
+        close( fd );
+        *pData = NULL;
+        *pTail = 0;
+        return(1);
+    }
+
+    addr = mmap( NULL, *pSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( addr == MAP_FAILED ) return(0);
+
+    if( pushBlock( w->rsp, addr, *pSize ) < 0 )
+    {
+        munmap( addr, *pSize );
+        return( SG_ERROR_NO_MEMORY );
+    }
+    *pData = (char *) addr;
+    *pTail = (*pSize % page) != 0;     /* the rest of the last page reads as zeros */
+    return(1);
+#else
+    FILE *fp = fopen( name, "rb" );
+    char *data;
+    long len;
+
+    if( fp == NULL ) return(0);
+    if( fseek( fp, 0, SEEK_END ) != 0 || (len = ftell( fp )) < 0 || fseek( fp, 0, SEEK_SET ) != 0 )
+    {
+        fclose( fp );
+        return(0);
+    }
+    data = (char *) malloc( (size_t) len + 1 );
+    SG_STATS_ADD( allocs, 1 );
+    if( data == NULL || fread( data, 1, (size_t) len, fp ) != (size_t) len )
+    {
+        free( data );
+        fclose( fp );
+        return( data == NULL ? SG_ERROR_NO_MEMORY : 0 );
+    }
+    fclose( fp );
+    data[len] = 0;
+
+    if( pushBlock( w->rsp, data, 0 ) < 0 )
+    {
+        free( data );
+        return( SG_ERROR_NO_MEMORY );
+    }
+    id->name = name;
+    *pData = data;
+    *pSize = (size_t) len;
+    *pTail = 1;
+    return(1);
+#endif
+}
+
+static int sameFile( const rspId_t *a, const rspId_t *b )
+{
+#ifndef _WIN32
+    return( a->dev == b->dev && a->ino == b->ino );
+#else
+    return( strcmp( a->name, b->name ) == 0 );
+#endif
+}
+
+static int isSpace( char c )
+{
+    return( c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f' );
+}
+
+static int expandArg( rspWalk_t *w, char *arg );
+
+/* split data[0..size) into arguments in place */
+static int tokenize( rspWalk_t *w, char *p, size_t size, int tail )
+{
+    char *end = p + size;
+    char *start, *out;
+    int sq, dq, n;
+
+    while( p < end )
+    {
+        while( p < end && isSpace( *p ) ) p++;
+        if( p >= end ) break;
+
+        start = out = p;
+        sq = dq = 0;
+        while( p < end )
+        {
+            if( !sq && !dq && isSpace( *p ) ) break;
+            if( *p == '\\' && !sq && p + 1 < end ) { *out++ = p[1]; p += 2; }
+            else if( *p == '\'' && !dq ) { sq = !sq; p++; }
+            else if( *p == '"' && !sq ) { dq = !dq; p++; }
+            else *out++ = *p++;
+        }
+
+        if( out < end ) *out = 0;     /* over a separator or a collapsed quote */
+        else if( tail ) *out = 0;     /* just past the data, still inside the last page */
+        else
+        {
+            /* last token runs to the very end of a page aligned file: the only copy made */
+            char *copy = (char *) malloc( (size_t) (out - start) + 1 );
+            SG_STATS_ADD( allocs, 1 );
+
+            if( copy == NULL || pushBlock( w->rsp, copy, 0 ) < 0 )
+            {
+                free( copy );
+                return( SG_ERROR_NO_MEMORY );
+            }
+            memcpy( copy, start, (size_t) (out - start) );
+            copy[out - start] = 0;
+            start = copy;
+        }
+        p++;
+
+        n = expandArg( w, start );
+        if( n < 0 ) return(n);
+    }
+    return(0);
+}
+
+/* append arg, or the contents of the file it names */
+static int expandArg( rspWalk_t *w, char *arg )
+{
+    rspId_t id;
+    char *data = NULL;
+    size_t size = 0;
+    int tail = 0;
+    int i, n;
+
+    if( arg[0] != '@' || arg[1] == 0 ) return( pushArg( w->rsp, arg ) );
+
+    n = loadFile( w, arg + 1, &id, &data, &size, &tail );
+    if( n < 0 ) return(n);
+    if( n == 0 ) return( pushArg( w->rsp, arg ) );     /* not a readable file: a literal argument */
+
+    for( i = 0 ; i < w->depth ; i++ )
+    {
+        if( sameFile( &w->open[i], &id ) )
+        {
+            return( SG_ERROR_RESPONSE_FILE );      /* includes itself */
+        }
+    }
+    if( w->depth == RSP_MAX_DEPTH )
+    {
+        return( SG_ERROR_RESPONSE_FILE );          /* nested too deep */
+    }
+
+    w->open[w->depth++] = id;
+    n = tokenize( w, data, size, tail );
+    w->depth--;
+
+    return(n);
+}
+
+int sgRspExpand( sgRsp_t *rsp, int argc, char **argv, int keep, int *pArgc, char ***pArgv, int *pBadArg )
+{
+    rspWalk_t w;
+    int i, n;
+
+    sgRspRelease( rsp );
+
+    *pArgc = argc;
+    *pArgv = argv;
+    *pBadArg = 0;
+
+    for( i = keep ; i < argc ; i++ )
+    {
+        if( argv[i] != NULL && argv[i][0] == '@' ) break;
+    }
+    if( i == argc ) return(0);      /* the common case: nothing to expand, nothing allocated */
+
+    w.rsp = rsp;
+    w.depth = 0;
+
+    for( i = 0 ; i < argc ; i++ )
+    {
+        n = (i < keep) ? pushArg( rsp, argv[i] ) : expandArg( &w, argv[i] );
+        if( n < 0 )
+        {
+            *pBadArg = i;
+            sgRspRelease( rsp );
+            return(n);
+        }
+    }
+
+    *pArgc = rsp->argc;
+    *pArgv = rsp->argv;
+    return(0);
+}
+
+void sgRspRelease( sgRsp_t *rsp )
+{
+    int i;
+
+    for( i = 0 ; i < rsp->numBlocks ; i++ ) freeBlock( &rsp->blocks[i] );
+    free( rsp->blocks );
+    free( rsp->argv );
+    memset( rsp, 0, sizeof(sgRsp_t) );
+}
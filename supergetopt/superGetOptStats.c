@@ -0,0 +1,134 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* instrumentation counters. Every thread adds to the same counters, atomically, so a summary
+    covers batch workers too. Only built in with SG_ENABLE_STATS */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "superGetOptInt.h"
+
+#if SG_ENABLE_STATS
+
+superOptStats_t sgStats;
+
+unsigned long long sgStatsNow( void )
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &freq );
+    return( (unsigned long long) (count.QuadPart * (1e9 / freq.QuadPart)) );
+#else
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (unsigned long long) ts.tv_sec * 1000000000ull + ts.tv_nsec );
+#endif
+}
+
+void sgStatsAdd( unsigned long long *counter, unsigned long long n )
+{
+#if defined(__GNUC__)
+    __atomic_fetch_add( counter, n, __ATOMIC_RELAXED );
+#elif defined(_WIN32)
+    InterlockedExchangeAdd64( (volatile LONG64 *) counter, (LONG64) n );
+#else
+    *counter += n;
+#endif
+}
+
+int superGetStats( superOptStats_t *stats )
+{
+    unsigned long long *from = (unsigned long long *) &sgStats, *to = (unsigned long long *) stats;
+    size_t i;
+
+    /* field by field, so no counter is read torn */
+    for( i = 0 ; i < sizeof(superOptStats_t) / sizeof(unsigned long long) ; i++ )
+    {
+#if defined(__GNUC__)
+        to[i] = __atomic_load_n( &from[i], __ATOMIC_RELAXED );
+#else
+        to[i] = from[i];
+#endif
+    }
+    return(0);
+}
+
+void superResetStats( void )
+{
+    unsigned long long *counter = (unsigned long long *) &sgStats;
+    size_t i;
+
+    for( i = 0 ; i < sizeof(superOptStats_t) / sizeof(unsigned long long) ; i++ )
+    {
+#if defined(__GNUC__)
+        __atomic_store_n( &counter[i], 0, __ATOMIC_RELAXED );
+#else
+        counter[i] = 0;
+#endif
+    }
+}
+
+#else
+
+int superGetStats( superOptStats_t *stats )
+{
+    memset( stats, 0, sizeof(superOptStats_t) );
+    return(-1);
+}
+
+void superResetStats( void )
+{
+}
+
+#endif
+
+void superPrintStats( const char *label )
+{
+    superOptStats_t st;
+
+    if( superGetStats( &st ) < 0 )
+    {
+        fprintf(stderr, "%s%ssuperGetOpt stats: not built in (SG_ENABLE_STATS)\n", label ? label : "", label ? ": " : "");
+        return;
+    }
+    fprintf(stderr, "%s%ssuperGetOpt stats: %llu tokens %llu lookups %llu bad conversions %llu allocs;"
+                    " format %.3f ms lookup %.3f ms convert %.3f ms group %.3f ms\n",
+            label ? label : "", label ? ": " : "", st.tokens, st.lookups, st.badConversions, st.allocs,
+            st.formatNs / 1e6, st.lookupNs / 1e6, st.convertNs / 1e6, st.groupNs / 1e6);
+}
@@ -0,0 +1,342 @@
+
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+
+/* Config reload: a watch re-parses a config file with superCtxParseFile when
+    it changes and says which options changed value. On Linux an inotify watch
+    on the file's directory says when (editors usually write a new file and
+    rename it over the old one); elsewhere, or without inotify, the file's
+    stat is compared at each check, and superWatchFd says -1. Polling looks
+    at the times to the nanosecond, and the ctime too, but a file written in
+    the second it was loaded is reloaded at each check until it is older:
+    its stamp alone can't tell two quick rewrites of the same length apart.
+
+    The variables are saved (sgSaveOption) when the watch opens, after each
+    good load, and again for comparing. A reload first puts the opening values
+    back, so a line taken out of the file returns its option to its default,
+    and a file that fails to parse gets the last good values put back. The
+    opening values are saved raw: a string the file doesn't set goes back to
+    the caller's own pointer, which outlives the watch.
+*/
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "supergetopt.h"
+#include "superGetOptInt.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* what polling compares: the times to the nanosecond where stat has them */
+typedef struct
+{
+    long long mtime, mtimeNs, ctime, ctimeNs, size, ino;
+} fileStamp_t;
+
+#if defined(__APPLE__)
+#define ST_MTIME_NS( st ) ((long long) (st).st_mtimespec.tv_nsec)
+#define ST_CTIME_NS( st ) ((long long) (st).st_ctimespec.tv_nsec)
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#define ST_MTIME_NS( st ) ((long long) (st).st_mtim.tv_nsec)
+#define ST_CTIME_NS( st ) ((long long) (st).st_ctim.tv_nsec)
+#else
+#define ST_MTIME_NS( st ) 0LL
+#define ST_CTIME_NS( st ) 0LL
+#endif
+
+typedef struct
+{
+    char *buf;
+    size_t cap;
+    size_t *offs;               /* option i is buf[offs[i]..offs[i+1]) */
+} snapshot_t;
+
+struct superWatch_s
+{
+    const superOptSpec_t *spec;
+    int numOpts;
+    superOptCtx_t *ctx;         /* the loaded string values live here */
+    char *path;
+    const char *base;           /* the file name part of path */
+    int fd;                     /* inotify descriptor, or -1 */
+    int loaded;
+    fileStamp_t stamp;          /* the file as last loaded */
+    time_t loadTime;            /*   and when */
+    snapshot_t defaults, cur, next;
+    const char **changed;       /* names of the options the last reload changed */
+    int numChanged;
+};
+
+static int takeSnapshot( superWatch_t *w, snapshot_t *s, int raw )
+{
+    size_t size = 0;
+    int i;
+
+    for( i = 0 ; i < w->numOpts ; i++ )
+    {
+        s->offs[i] = size;
+        size += sgSaveOption( w->spec, i, NULL, 0, raw );
+    }
+    s->offs[w->numOpts] = size;
+
+    if( size > s->cap )
+    {
+        char *buf = (char *) realloc( s->buf, size );
+        SG_STATS_ADD( allocs, 1 );
+
+        if( buf == NULL ) return( SG_ERROR_NO_MEMORY );
+        s->buf = buf;
+        s->cap = size;
+    }
+    for( i = 0 ; i < w->numOpts ; i++ ) sgSaveOption( w->spec, i, s->buf + s->offs[i], s->offs[i+1] - s->offs[i], raw );
+    return(0);
+}
+
+static void putBack( superWatch_t *w, snapshot_t *s )
+{
+    int i;
+
+    for( i = 0 ; i < w->numOpts ; i++ ) sgRestoreOption( w->spec, i, s->buf + s->offs[i] );
+}
+
+static void getStamp( const struct stat *st, fileStamp_t *stamp )
+{
+    stamp->mtime = (long long) st->st_mtime;
+    stamp->mtimeNs = ST_MTIME_NS( *st );
+    stamp->ctime = (long long) st->st_ctime;
+    stamp->ctimeNs = ST_CTIME_NS( *st );
+    stamp->size = (long long) st->st_size;
+    stamp->ino = (long long) st->st_ino;
+}
+
+/* 1 if the file may have changed since it was last loaded */
+static int fileChanged( superWatch_t *w )
+{
+    struct stat st;
+    fileStamp_t stamp;
+    int changed = !w->loaded;
+
+#ifdef __linux__
+    if( w->fd >= 0 )
+    {
+        char events[4096] __attribute__(( aligned( __alignof__( struct inotify_event ) ) ));
+        const struct inotify_event *ev;
+        ssize_t n;
+        char *p;
+
+        while( (n = read( w->fd, events, sizeof(events) )) > 0 )
+        {
+            for( p = events ; p < events + n ; p += sizeof(struct inotify_event) + ev->len )
+            {
+                ev = (const struct inotify_event *) p;
+                if( (ev->mask & IN_Q_OVERFLOW) || (ev->len > 0 && strcmp( ev->name, w->base ) == 0) ) changed = 1;
+            }
+        }
+        return( changed );
+    }
+#endif
+
+    if( stat( w->path, &st ) != 0 ) return( changed );
+    getStamp( &st, &stamp );
+    if( memcmp( &stamp, &w->stamp, sizeof(stamp) ) != 0 ) changed = 1;
+
+    /* a file stamped no earlier than the second before it was loaded can be rewritten
+        with the same stamp (filesystem times are coarse), so it is reloaded until older */
+    if( (time_t) stamp.mtime >= w->loadTime - 1 || (time_t) stamp.ctime >= w->loadTime - 1 ) changed = 1;
+    return( changed );
+}
+
+static void noteFile( superWatch_t *w )
+{
+    struct stat st;
+
+    w->loadTime = time( NULL );
+    if( stat( w->path, &st ) == 0 ) getStamp( &st, &w->stamp );
+}
+
+void superWatchClose( superWatch_t *watch )
+{
+    snapshot_t *s[3];
+    int i;
+
+    if( watch == NULL ) return;
+
+#ifdef __linux__
+    if( watch->fd >= 0 ) close( watch->fd );
+#endif
+    s[0] = &watch->defaults;
+    s[1] = &watch->cur;
+    s[2] = &watch->next;
+    for( i = 0 ; i < 3 ; i++ )
+    {
+        free( s[i]->buf );
+        free( s[i]->offs );
+    }
+    superCtxFree( watch->ctx );
+    free( watch->changed );
+    free( watch->path );
+    free( watch );
+}
+
+int superWatchOpen( superWatch_t **pWatch, const superOptSpec_t *spec, const char *path )
+{
+    superWatch_t *w;
+    size_t len;
+    char *slash;
+    int i;
+
+    if( pWatch == NULL || spec == NULL || path == NULL ) return( SG_ERROR_MISSING_ARG );
+    *pWatch = NULL;
+
+    w = (superWatch_t *) calloc( 1, sizeof(superWatch_t) );
+    SG_STATS_ADD( allocs, 1 );
+    if( w == NULL ) return( SG_ERROR_NO_MEMORY );
+
+    w->spec = spec;
+    w->numOpts = sgNumOptions( spec );
+    w->fd = -1;
+    len = strlen( path );
+    w->path = (char *) malloc( len + 1 );
+    w->ctx = superCtxNew();
+    w->changed = (const char **) malloc( (w->numOpts + 1) * sizeof(char *) );
+    w->defaults.offs = (size_t *) malloc( (w->numOpts + 1) * sizeof(size_t) );
+    w->cur.offs = (size_t *) malloc( (w->numOpts + 1) * sizeof(size_t) );
+    w->next.offs = (size_t *) malloc( (w->numOpts + 1) * sizeof(size_t) );
+    SG_STATS_ADD( allocs, 5 );
+
+    /* * lists start empty, as they do at any parse */
+    for( i = 0 ; i < w->numOpts && w->ctx != NULL ; i++ ) sgParseOption( w->ctx, spec, i, 1, 0, NULL, NULL );
+    if( w->path == NULL || w->ctx == NULL || w->changed == NULL || w->defaults.offs == NULL || w->cur.offs == NULL || w->next.offs == NULL ||
+        takeSnapshot( w, &w->defaults, 1 ) < 0 || takeSnapshot( w, &w->cur, 0 ) < 0 )
+    {
+        superWatchClose( w );
+        return( SG_ERROR_NO_MEMORY );
+    }
+    memcpy( w->path, path, len + 1 );
+    if( sgThreadCtx() != NULL ) sgCtxCopyModes( w->ctx, sgThreadCtx() );
+    slash = strrchr( w->path, '/' );
+    w->base = slash ? slash + 1 : w->path;
+
+#ifdef __linux__
+    w->fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if( w->fd >= 0 )
+    {
+        int wd;
+
+        /* the directory, so a file replaced by rename is still seen */
+        if( slash ) *slash = 0;
+        wd = inotify_add_watch( w->fd, slash ? (slash == w->path ? "/" : w->path) : ".",
+                                IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM );
+        if( slash ) *slash = '/';
+        if( wd < 0 )
+        {
+            close( w->fd );
+            w->fd = -1;
+        }
+    }
+#endif
+
+    *pWatch = w;
+    return(0);
+}
+
+int superWatchCheck( superWatch_t *watch, int *lastLine )
+{
+    snapshot_t t;
+    int lineDummy;
+    int i, n;
+
+    if( lastLine == NULL ) lastLine = &lineDummy;
+    *lastLine = 0;
+    if( watch == NULL ) return( SG_ERROR_MISSING_ARG );
+
+    watch->numChanged = 0;
+    if( !fileChanged( watch ) ) return(0);
+    noteFile( watch );
+    watch->loaded = 1;
+
+    putBack( watch, &watch->defaults );
+    n = superCtxParseFile( watch->ctx, watch->spec, watch->path, lastLine );
+    if( n == 0 ) n = takeSnapshot( watch, &watch->next, 0 );
+    if( n < 0 )
+    {
+        putBack( watch, &watch->cur );
+        return(n);
+    }
+
+    for( i = 0 ; i < watch->numOpts ; i++ )
+    {
+        size_t a = watch->cur.offs[i+1] - watch->cur.offs[i];
+        size_t b = watch->next.offs[i+1] - watch->next.offs[i];
+
+        if( a != b || memcmp( watch->cur.buf + watch->cur.offs[i], watch->next.buf + watch->next.offs[i], a ) != 0 )
+        {
+            watch->changed[watch->numChanged++] = sgOptionName( watch->spec, i );
+        }
+    }
+
+    t = watch->cur;
+    watch->cur = watch->next;
+    watch->next = t;
+    return( watch->numChanged );
+}
+
+const char *const *superWatchChanged( const superWatch_t *watch, int *numChanged )
+{
+    if( numChanged ) *numChanged = watch ? watch->numChanged : 0;
+    return( watch ? watch->changed : NULL );
+}
+
+int superWatchFd( const superWatch_t *watch )
+{
+    return( watch ? watch->fd : -1 );
+}
+
+void superWatchPoll( superWatch_t *watch )
+{
+    if( watch == NULL ) return;
+#ifdef __linux__
+    if( watch->fd >= 0 ) close( watch->fd );
+#endif
+    watch->fd = -1;
+}
+
+const superDiag_t *superWatchDiag( const superWatch_t *watch )
+{
+    return( watch ? superCtxLastDiag( watch->ctx ) : NULL );
+}
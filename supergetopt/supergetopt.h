@@ -28,6 +28,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __SUPERGETOPT
 
 #include <stdarg.h>
+#include <stddef.h>
 
 /* The function prototypes you need */
 
@@ -44,22 +45,309 @@ void usage();
 // for parsing args in a file, for instance, where argv[0] isn't ignored
 int superParseOpt( int argc, char **argv, int *lastArg, ... );
 
+// a compiled option spec: formats are parsed and pointers bound once by superCompileOpt()
+typedef struct superOptSpec_s superOptSpec_t;
+
+// compile the same format/pointer/helpString list superParseOpt takes (NULL terminated). A bad
+// format is left in the thread's superLastDiag, as a superParseOpt would leave it
+int superCompileOpt( superOptSpec_t **pSpec, ... );
+int superVCompileOpt( superOptSpec_t **pSpec, va_list ap );
+
+// value types, one per % conversion: %c %hd %d %u %x %ld %f %lf %s, and
+// %B, a byte size into an unsigned long long: 4096, 64K (1000s), 64Ki (1024s), 4G, 1.5MiB ...
+// %T, a duration into a long long of nanoseconds: 250ms, 1h30m, 2.5s, 10us ...
+enum { SG_TYPE_CHAR, SG_TYPE_SHORT, SG_TYPE_INT, SG_TYPE_UINT, SG_TYPE_HEX, SG_TYPE_LONG,
+       SG_TYPE_FLOAT, SG_TYPE_DOUBLE, SG_TYPE_STRING, SG_TYPE_SIZE, SG_TYPE_DURATION, SG_NUM_TYPES };
+
+// how a var list is stored: a C array of *pNumArgs entries, or (C++ builds) a std::vector of
+// its type (std::vector<const char *> for %s), or for *%s a std::vector<std::string_view> (C++17).
+// A list of tuples, "-point *(%s %lf %lf)", labels, xs, ys, &numPoints, stores each field in its
+// own array (or vector): *pNumArgs counts whole tuples, and a tuple cut short is a missing arg
+// SG_BIND_SINK (any option with values) stores nothing: each value goes to a callback.
+// SG_BIND_GROW (any option with values, "+" before the %) keeps every occurrence: "-I +%s",
+// &paths, &numPaths appends to an array the library grows (doubling) and points paths at. Each
+// field binds a T ** that starts NULL, then the int * count of values (tuples) of this parse
+enum { SG_BIND_ARRAY, SG_BIND_VECTOR, SG_BIND_VIEWS, SG_BIND_SINK, SG_BIND_GROW };
+
+// what a sink is called with: once per value as it is converted, then once more (value NULL)
+// when the occurrence of the option is complete
+typedef struct superSinkEvent_s
+{
+    const char *name;           // the option
+    int type;                   // SG_TYPE_* of this value
+    int index;                  // value number within this occurrence, from 0 (a tuple's field is index % fields)
+    const void *value;          // the value (a char ** for %s), NULL at the end of the occurrence
+    int count;                  // at the end: the number of values the occurrence had
+} superSinkEvent_t;
+
+// a sink returns 0 to go on, or an SG_ERROR_* code to stop the parse with it.
+// Give ">" before the %s (or *%) and the sink and its user pointer instead of the value pointers:
+//     "-v >*%lf", onValue, &myData, "values streamed to onValue"
+typedef int (*superSink_t)( void *user, const superSinkEvent_t *event );
+
+// one option of a table, already parsed: what "-v *%lf", values, &numValues, "help" says
+typedef struct superOptDesc_s
+{
+    const char *name;           // "-v"
+    int varflag;                // 1 for a * list: one type, or with numArgs > 1 a list of tuples
+    int numArgs;                // number of types and ptrs; 0 for a flag, bound to ptrs[0] (an int *)
+    const int *types;           // SG_TYPE_* per arg
+    void * const *ptrs;         // where each value goes
+    int *pNumArgs;              // var lists and SG_BIND_GROW: number of values found
+    int bind;                   // var lists: SG_BIND_*. SG_BIND_GROW and SG_BIND_SINK for any option
+    const char *helpString;
+    superSink_t sink;           // SG_BIND_SINK: ptrs and pNumArgs are unused
+    void *sinkUser;
+} superOptDesc_t;
+
+// compile a table of options: no format parsing and no varargs
+int superCompileTable( superOptSpec_t **pSpec, const superOptDesc_t *table, int numOpts );
+
+// parse with a compiled spec. Same conventions as superParseOpt: argv[0] isn't ignored
+int superParseSpec( const superOptSpec_t *spec, int argc, char **argv, int *lastArg );
+
+// print usage for a compiled spec, and release it
+void superUsageSpec( const superOptSpec_t *spec );
+void superFreeOpt( superOptSpec_t *spec );
+
+// the usage text itself: names and types, then help strings in one column wrapped to width
+// (0: the terminal's, else $COLUMNS, else 80). Rendered once per width and kept with the spec
+// until it is freed or recompiled; usage printing writes it to stderr in one go
+const char *superUsageText( const superOptSpec_t *spec, int width, size_t *len );
+
+// A parse context carries all parse state, so threads never share any.
+// superGetOpt, superParseOpt, superParseSpec and usage() use one per thread.
+typedef struct superOptCtx_s superOptCtx_t;
+
+// heap allocated context
+superOptCtx_t *superCtxNew( void );
+void superCtxFree( superOptCtx_t *ctx );
+
+// caller allocated context: mem must hold superCtxSize() bytes and stay put while in use.
+// superCtxRelease frees what the context allocated, but not mem
+size_t superCtxSize( void );
+superOptCtx_t *superCtxInit( void *mem, size_t size );
+void superCtxRelease( superOptCtx_t *ctx );
+
+// superGetOpt, superParseOpt, superParseSpec and usage with an explicit context
+int superCtxGetOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, ... );
+int superCtxVGetOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, va_list ap );
+int superCtxParseOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, ... );
+int superCtxVParseOpt( superOptCtx_t *ctx, int argc, char **argv, int *lastArg, va_list ap );
+int superCtxParseSpec( superOptCtx_t *ctx, const superOptSpec_t *spec, int argc, char **argv, int *lastArg );
+void superCtxUsage( superOptCtx_t *ctx );
+
+// parse a config file of "name value value ..." lines ("-" for stdin) with a compiled spec.
+// Names match with or without their leading '-'s; '#' comments out the rest of a line and a
+// trailing '\' continues it. String values are copied and live until the next superParseFile
+// on the same thread (context). Returns 0 or an SG_ERROR_* code, *lastLine the line at fault
+int superParseFile( const superOptSpec_t *spec, const char *path, int *lastLine );
+int superCtxParseFile( superOptCtx_t *ctx, const superOptSpec_t *spec, const char *path, int *lastLine );
+
+// the argv the last superGetOpt/superParseOpt call actually parsed: with @file arguments
+// expanded, it is what argPos indexes and where unaccounted for args are grouped.
+// Expanded tokens point into the mapped files and stay valid until the next call
+char **superArgv( int *argc );
+char **superCtxArgv( superOptCtx_t *ctx, int *argc );
+
+// extra (unaccounted for) args: argv[start] ... argv[start+count-1], with start counted the way
+// argPos is (so 1-based for superParseOpt and superParseSpec)
+typedef struct superArgSpan_s
+{
+    int start;
+    int count;
+} superArgSpan_t;
+
+// SG_EXTRAS_GROUP (the default) moves extra args together in argv; SG_EXTRAS_SPANS leaves argv
+// untouched. Either way argPos is the first extra arg and superExtraSpans says where they all are
+enum { SG_EXTRAS_GROUP, SG_EXTRAS_SPANS };
+void superSetExtrasMode( int mode );
+void superCtxSetExtrasMode( superOptCtx_t *ctx, int mode );
+
+// SG_NAMES_EXACT (the default) takes option names as written; SG_NAMES_PREFIX also takes the
+// unique start of a name ("--verb" for "--verbose"). A start shared by several names is
+// SG_ERROR_AMBIGUOUS_ARG, with argPos on it
+enum { SG_NAMES_EXACT, SG_NAMES_PREFIX };
+void superSetNameMode( int mode );
+void superCtxSetNameMode( superOptCtx_t *ctx, int mode );
+
+// environment fallback: with a prefix set, each parse (superGetOpt, superParseOpt, superParseSpec)
+// takes the options argv didn't give from variables named prefix plus the option name in upper
+// case, leading '-'s dropped and other punctuation as '_': "MYTOOL_" reads -threads from
+// MYTOOL_THREADS. A flag is set by any value but "" and "0", a single %s takes the whole value
+// and other values are split at blanks. A single %s points into environ, as one from argv
+// points into argv; a %s split from a list is a copy kept until the next parse on the context.
+// A bad variable fails the parse with argPos 0 and the variable in superLastDiag. prefix must
+// stay valid; NULL (the default) turns this off
+void superSetEnvPrefix( const char *prefix );
+void superCtxSetEnvPrefix( superOptCtx_t *ctx, const char *prefix );
+
+// an option may also come with its first value in the same arg, "--threads=8" for any name or
+// "-n8" for a one character name, and one character flags may be bundled: "-xvf out" is
+// "-x -v -f out". Neither copies or changes argv. Lazy handles only split plain names
+
+// completion: the option names starting with prefix, in sorted order. Returns how many there
+// are and puts up to maxNames of them in names. superComplete asks the spec of this thread's
+// last superGetOpt/superParseOpt call
+int superCompleteSpec( const superOptSpec_t *spec, const char *prefix, const char **names, int maxNames );
+int superComplete( const char *prefix, const char **names, int maxNames );
+
+// what went wrong in the last parse, filled in instead of printed
+typedef struct superDiag_s
+{
+    int code;                   // the SG_ERROR_* returned, 0 if none
+    const char *source;         // args not from argv: the config file (argIndex is the line) or variable
+    int argIndex;               // the arg at fault, counted the way argPos is
+    const char *option;         // the option being parsed, NULL if none
+    int expectedType;           // SG_TYPE_* the arg should have been, -1 if none
+    char token[64];             // the arg at fault, cut to fit
+    int dropped;                // values past the end of an array, ignored without an error
+    const char *droppedOption;  //   the first option that had some
+} superDiag_t;
+
+// SG_STRINGS_ARGV (the default) leaves %s values pointing into argv. SG_STRINGS_OWNED copies
+// them into the context, so argv can be a buffer that is reused: each parse (superGetOpt,
+// superParseOpt, superParseSpec, superParseFile) makes room for all of its args at once and
+// the copies last until the next one, which reuses the memory. SG_STRINGS_KEEP keeps adding
+// copies, parse after parse. Either way superFreeStrings frees them all. Batches always point
+// into the records' argv, and extra args always point into argv
+enum { SG_STRINGS_ARGV, SG_STRINGS_OWNED, SG_STRINGS_KEEP };
+void superSetStringMode( int mode );
+void superCtxSetStringMode( superOptCtx_t *ctx, int mode );
+void superFreeStrings( void );
+void superCtxFreeStrings( superOptCtx_t *ctx );
+
+// the arrays of SG_BIND_GROW options belong to the context that grew them: they keep their
+// memory from parse to parse, and superFreeLists frees them all, setting their pointers back
+// to NULL (so call it while those are still in scope). superCtxRelease frees them too, but
+// leaves the pointers alone
+void superFreeLists( void );
+void superCtxFreeLists( superOptCtx_t *ctx );
+
+// SG_DIAG_STDERR (the default when built with SG_DEBUG) prints the diagnostics of each parse
+// that had some, once, when it returns; SG_DIAG_QUIET leaves them to superLastDiag, so
+// parsing makes no stdio calls. Batches, lazy handles and watches take the calling thread's mode
+enum { SG_DIAG_QUIET, SG_DIAG_STDERR };
+void superSetDiagMode( int mode );
+void superCtxSetDiagMode( superOptCtx_t *ctx, int mode );
+const superDiag_t *superLastDiag( void );
+const superDiag_t *superCtxLastDiag( const superOptCtx_t *ctx );
+
+// one line of text for a diag, snprintf style; superPrintDiag writes it to stderr
+int superFormatDiag( const superDiag_t *diag, char *buf, size_t size );
+void superPrintDiag( const superDiag_t *diag );
+const char *superErrorString( int code );
+
+// the extra args of the last parse, in order: one span when grouped
+const superArgSpan_t *superExtraSpans( int *numSpans );
+const superArgSpan_t *superCtxExtraSpans( superOptCtx_t *ctx, int *numSpans );
+
+// one argument vector of a batch. outBase is where this record's values go; status and
+// lastArg are what superParseSpec would have returned for it
+typedef struct superBatchRec_s
+{
+    int argc;
+    char **argv;
+    void *outBase;
+    int status;
+    int lastArg;
+} superBatchRec_t;
+
+// parse numRecs records with one spec on numThreads threads (<= 0: one per online cpu).
+// The spec must have been compiled against pointers inside [bindBase, bindBase+bindSize),
+// typically one struct; each record's values are written at the same offsets from its outBase.
+// Records are parsed with the calling thread's name, extras and diagnostics modes and
+// environment prefix. %s values point into the records' argv (or environ) whatever the string
+// mode, and a %s list from the environment is SG_ERROR_BAD_BINDING, having nowhere to live
+int superParseBatch( const superOptSpec_t *spec, const void *bindBase, size_t bindSize, superBatchRec_t *recs, int numRecs, int numThreads );
+
+// lazy parsing: superParseLazy only splits argv among the spec's options (unknown options and
+// fixed options short of args are still errors there, and so is a bundle of one character
+// options, "-xvf"; "--name=value" is fine) and returns the extra arg count like
+// superParseSpec, leaving argv as is. superLazyGet converts one option's values into its
+// variables on first use, with the usual checks, and returns the same answer after that:
+// how many values were given (flags: how often), 0 if the option wasn't, or an SG_ERROR_*
+// code with *lastArg at fault. The handle takes the calling thread's name and diagnostics
+// modes. argv must outlive the handle; one thread per handle
+typedef struct superLazy_s superLazy_t;
+int superParseLazy( const superOptSpec_t *spec, int argc, char **argv, int *lastArg, superLazy_t **pLazy );
+int superLazyGet( superLazy_t *lazy, const char *name, int *lastArg );
+const superArgSpan_t *superLazyExtraSpans( const superLazy_t *lazy, int *numSpans );
+// what went wrong in the handle's last conversion. superParseLazy's own errors go to superLastDiag
+const superDiag_t *superLazyDiag( const superLazy_t *lazy );
+void superFreeLazy( superLazy_t *lazy );
+
+// config reload for long running programs: a watch re-parses a config file (see superParseFile)
+// when it changes, inotify telling when on Linux and the file's stat elsewhere. Each reload
+// starts from the values the variables had when the watch was opened, so a line taken out goes
+// back to its default; a file that fails to parse leaves the last good values in place.
+// %s values the file set live in the watch, until superWatchClose; a string option the file
+// never set keeps the pointer it had when the watch was opened. The watch parses with the
+// modes the opening thread had
+typedef struct superWatch_s superWatch_t;
+int superWatchOpen( superWatch_t **pWatch, const superOptSpec_t *spec, const char *path );
+void superWatchClose( superWatch_t *watch );
+
+// reload if the file changed since the last check (the first check always loads it). Returns how
+// many options changed value, 0 for no change, or an SG_ERROR_* code with *lastLine at fault
+int superWatchCheck( superWatch_t *watch, int *lastLine );
+
+// the names of the options the last superWatchCheck changed
+const char *const *superWatchChanged( const superWatch_t *watch, int *numChanged );
+
+// a descriptor that turns readable when the file may have changed (poll/select on it,
+// then superWatchCheck), or -1 when changes are only found by checking
+int superWatchFd( const superWatch_t *watch );
+
+// compare the file's stat at each check from now on, for files inotify doesn't see change
+// (network filesystems, for one). superWatchFd is -1 after
+void superWatchPoll( superWatch_t *watch );
+
+// what went wrong in the last reload
+const superDiag_t *superWatchDiag( const superWatch_t *watch );
+
+// instrumentation, process wide. Only counted when the library is built with SG_ENABLE_STATS (make STATS=1)
+typedef struct superOptStats_s
+{
+    unsigned long long formatNs;        // parsing formats into options (parse_string)
+    unsigned long long lookupNs;        // finding option names
+    unsigned long long convertNs;       // converting values
+    unsigned long long groupNs;         // moving extra args together
+    unsigned long long tokens;          // argv entries parsed
+    unsigned long long lookups;
+    unsigned long long badConversions;  // values that didn't convert, including the token ending a var list
+    unsigned long long allocs;          // malloc, calloc and realloc calls
+} superOptStats_t;
+
+// copy the counters; returns 0, or -1 (and zeroes *stats) when built without SG_ENABLE_STATS
+int superGetStats( superOptStats_t *stats );
+void superResetStats( void );
+// one line summary on stderr, prefixed with label if not NULL
+void superPrintStats( const char *label );
+
 #ifdef __cplusplus
 }
 #endif
 
 #ifdef __cplusplus
 #include <vector>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 #endif
 
 /* control SuperGetOpt API and behaviour */
 #define SG_ENABLE_HELPSTRING 1 // if enabled, each flag requires a helpString parameter from the caller
 #define SG_GROUP_UNACC_ARGS 1 /* group all unaccounted for arguments so it is easy to process them */
+#define SG_ENABLE_RESPONSE_FILES 1 /* superGetOpt and superParseOpt replace @file args with the file's args */
 #define SG_DEBUG 1
+#ifndef SG_ENABLE_STATS
+#define SG_ENABLE_STATS 0 /* time and count the parser's phases, see superGetStats(). Off costs nothing */
+#endif
 
 
 #define SG_ERROR_PRINT_USAGE -1
-#define SG_ERROR_TOO_MANY_OPTIONS -2
+#define SG_ERROR_TOO_MANY_OPTIONS -2 // no longer returned: there is no limit on options
 #define SG_ERROR_BAD_FORMAT -3
 #define SG_ERROR_BAD_FORMAT_TYPE -4
 #define SG_ERROR_BAD_ARGTYPE -5
@@ -69,8 +357,12 @@ int superParseOpt( int argc, char **argv, int *lastArg, ... );
 #define SG_ERROR_NO_FORMATS -9
 #define SG_ERROR_MIXED_TYPES_IN_VAR -10
 #define SG_ERROR_ZERO_LEN_OPTION -11
-#define SG_ERROR_TOO_MANY_ARGS -12
+#define SG_ERROR_TOO_MANY_ARGS -12 // no longer returned: there is no limit on args per option
 #define SG_ERROR_UNKNOWN_ARG -13
+#define SG_ERROR_NO_MEMORY -14
+#define SG_ERROR_BAD_BINDING -15
+#define SG_ERROR_RESPONSE_FILE -16
+#define SG_ERROR_AMBIGUOUS_ARG -17
 
 
 #endif
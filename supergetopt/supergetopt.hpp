@@ -0,0 +1,412 @@
+/*********************************************************************
+
+Copyright (c) 2007, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+
+/* C++17 front end: formats are parsed by the compiler, not at run time.
+
+    superOptSpec_t *spec;
+    int n = sg::compile( &spec, SG_OPT( "-puffy %c %lf %s %d", &c, &lf, &s, &d, "help message 1" ),
+                                SG_OPT( "-vfloat *%f", farray, &numf, "help message 4.f" ),
+                                SG_OPT( "--ivector *%d", &myVecI, &numv, "vector of ints" ),
+                                SG_OPT( "-help", &helpSet, "to get this help message" ) );
+    n = superParseSpec( spec, argc - 1, argv + 1, &argPos );
+
+    A bad conversion, a wrong number of pointers, or a pointer that doesn't
+    match its % is a compile error. What reaches the library is a
+    superOptDesc_t table built from constants, so superCompileTable() neither
+    parses formats nor walks a va_list.
+
+    A * list can fill a C array (with its capacity in the count), a
+    std::vector of its type, a std::vector<std::string_view> for *%s, or with
+    C++20 a std::span over a caller buffer (the count comes back as the number
+    filled: use values.first( num )). A *( ) list of tuples binds one array,
+    or one std::vector, per field and then the count:
+
+        SG_OPT( "-point *(%s %lf %lf)", labels, xs, ys, &numPoints, "labeled points" )
+
+    With ">" before the % the values go to a
+    callable instead, as they are converted:
+
+        auto add = [&]( double v ) { sum += v; };
+        SG_OPT( "-v >*%lf", &add, "values, summed as they come" )
+
+    With "+" before the % every occurrence is kept, in arrays the library
+    grows and superFreeLists() frees:
+
+        char **paths = NULL;
+        SG_OPT( "-I +%s", &paths, &numPaths, "include path, repeatable" )
+
+    Vectors are grown once per occurrence, to fit every value up to the next
+    option name. Vector lists need the library itself built as C++
+    (make CC=g++), otherwise compile returns SG_ERROR_BAD_VARARGTYPE.
+*/
+
+#ifndef __SUPERGETOPT_HPP
+#define __SUPERGETOPT_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <string_view>
+#include <vector>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define SG_HAVE_SPAN 1
+#endif
+#include "supergetopt.h"
+
+#if __cplusplus < 201703L
+#error "supergetopt.hpp needs C++17"
+#endif
+
+// one option: the format string, then the same pointers (and help string) superGetOpt takes
+#define SG_OPT( fmt, ... ) \
+    ::sg::detail::makeOption( [] { struct F { static constexpr const char *str() { return fmt; } }; return F(); }(), __VA_ARGS__ )
+
+namespace sg
+{
+
+/* one option, ready for the table: constant name and types, the caller's pointers */
+template<int NumPtrs>
+struct option
+{
+    const char *name;
+    const int *types;
+    int numArgs;
+    int varflag;
+    void *ptrs[NumPtrs];
+    int *pNumArgs;
+    int bind;
+    const char *helpString;
+    superSink_t sink;
+    void *sinkUser;
+
+    superOptDesc_t desc() const
+    {
+        superOptDesc_t d = { name, varflag, numArgs, types, ptrs, pNumArgs, bind, helpString, sink, sinkUser };
+        return( d );
+    }
+};
+
+namespace detail
+{
+
+constexpr std::size_t length( const char *s )
+{
+    std::size_t n = 0;
+    while( s[n] ) n++;
+    return( n );
+}
+
+constexpr bool startsWith( const char *s, const char *prefix )
+{
+    while( *prefix ) if( *s++ != *prefix++ ) return( false );
+    return( true );
+}
+
+constexpr int countConversions( const char *s )
+{
+    int n = 0;
+    for( ; *s ; s++ ) if( *s == '%' ) n++;
+    return( n );
+}
+
+/* what parse_string and parse_format make of a format, worked out by the compiler */
+template<std::size_t Len, int MaxConv>
+struct format
+{
+    char name[Len + 1] = {};
+    int types[MaxConv > 0 ? MaxConv : 1] = {};
+    int numArgs = 0;
+    bool var = false;
+    bool tuple = false;
+    bool grow = false;
+    bool sink = false;
+    bool badConversion = false;
+    bool noName = false;
+};
+
+template<std::size_t Len, int MaxConv>
+constexpr format<Len, MaxConv> parseFormat( const char *s )
+{
+    format<Len, MaxConv> f;
+    std::size_t pct = 0, nameLen = 0, i = 0;
+
+    while( pct < Len && s[pct] != '%' ) pct++;
+    for( i = 0 ; i < Len ; i++ ) if( s[i] == '*' ) f.var = true;
+
+    /* the name is what comes before the first %, less the space, the '>' or '+', the '*' and a tuple's '(' */
+    std::size_t markers = f.var ? 1 : 0;
+    if( f.var && pct < Len && pct > 0 && s[pct - 1] == '(' ) f.tuple = true;
+    markers += f.tuple ? 1 : 0;
+    if( pct < Len && pct > markers + 1 && s[pct - 1 - markers] == '+' ) f.grow = true;
+    markers += f.grow ? 1 : 0;
+    if( pct < Len && pct > markers + 1 && s[pct - 1 - markers] == '>' ) f.sink = true;
+    markers += f.sink ? 1 : 0;
+    if( pct == Len ) nameLen = Len;
+    else if( pct > markers + 1 ) nameLen = pct - markers - 1;
+    for( i = 0 ; i < nameLen ; i++ ) f.name[i] = s[i];
+    f.noName = nameLen == 0 || Len < 2;
+
+    for( i = pct ; i < Len ; i++ )
+    {
+        const char *c = s + i + 1;
+        int type = -1;
+
+        if( s[i] != '%' ) continue;
+        if( startsWith( c, "lf" ) ) type = SG_TYPE_DOUBLE;
+        else if( startsWith( c, "hd" ) ) type = SG_TYPE_SHORT;
+        else if( startsWith( c, "ld" ) ) type = SG_TYPE_LONG;
+        else if( *c == 'f' ) type = SG_TYPE_FLOAT;
+        else if( *c == 'c' ) type = SG_TYPE_CHAR;
+        else if( *c == 'd' ) type = SG_TYPE_INT;
+        else if( *c == 's' ) type = SG_TYPE_STRING;
+        else if( *c == 'u' ) type = SG_TYPE_UINT;
+        else if( *c == 'x' ) type = SG_TYPE_HEX;
+        else if( *c == 'B' ) type = SG_TYPE_SIZE;
+        else if( *c == 'T' ) type = SG_TYPE_DURATION;
+        else f.badConversion = true;
+        if( type >= 0 ) f.types[f.numArgs++] = type;
+    }
+    return( f );
+}
+
+template<class Fmt>
+struct parsed
+{
+    static constexpr auto f = parseFormat<length( Fmt::str() ), countConversions( Fmt::str() )>( Fmt::str() );
+};
+
+/* the pointer each SG_TYPE_* is written through, and the vector a list of it may fill */
+template<int T> struct value;
+template<> struct value<SG_TYPE_CHAR>   { typedef char type;         typedef std::vector<char> vector; };
+template<> struct value<SG_TYPE_SHORT>  { typedef short type;        typedef std::vector<short> vector; };
+template<> struct value<SG_TYPE_INT>    { typedef int type;          typedef std::vector<int> vector; };
+template<> struct value<SG_TYPE_UINT>   { typedef unsigned int type; typedef std::vector<unsigned int> vector; };
+template<> struct value<SG_TYPE_HEX>    { typedef unsigned int type; typedef std::vector<unsigned int> vector; };
+template<> struct value<SG_TYPE_LONG>   { typedef long type;         typedef std::vector<long> vector; };
+template<> struct value<SG_TYPE_FLOAT>  { typedef float type;        typedef std::vector<float> vector; };
+template<> struct value<SG_TYPE_DOUBLE> { typedef double type;       typedef std::vector<double> vector; };
+template<> struct value<SG_TYPE_STRING> { typedef char *type;        typedef std::vector<const char *> vector; };
+template<> struct value<SG_TYPE_SIZE>   { typedef unsigned long long type; typedef std::vector<unsigned long long> vector; };
+template<> struct value<SG_TYPE_DURATION> { typedef long long type;  typedef std::vector<long long> vector; };
+
+template<int T, class P>
+constexpr bool isArray()
+{
+    return( std::is_same<P, typename value<T>::type *>::value );
+}
+
+template<int T, class P>
+constexpr bool isVector()
+{
+    return( std::is_same<P, typename value<T>::vector *>::value );
+}
+
+template<int T, class P>
+constexpr bool isViews()
+{
+    return( T == SG_TYPE_STRING && std::is_same<P, std::vector<std::string_view> *>::value );
+}
+
+template<class P> struct spanOf { typedef void type; };
+#ifdef SG_HAVE_SPAN
+template<class E> struct spanOf<std::span<E>> { typedef E type; };
+#endif
+
+/* a caller buffer: std::span<T> of the list's type */
+template<int T, class P>
+constexpr bool isSpan()
+{
+    return( std::is_same<typename spanOf<P>::type, typename value<T>::type>::value );
+}
+
+/* what the library is handed for one argument */
+template<class P>
+void *toPtr( P p )
+{
+    if constexpr( !std::is_void<typename spanOf<P>::type>::value ) return( (void *) p.data() );
+    else return( (void *) p );
+}
+
+/* a sink callable gets either every superSinkEvent_t, or just each value of a single type option */
+template<class F, class A>
+int sinkResult( F &f, const A &a )
+{
+    if constexpr( std::is_void<decltype( f( a ) )>::value )
+    {
+        f( a );
+        return(0);
+    }
+    else return( (int) f( a ) );
+}
+
+template<class F, int T>
+int sinkCall( void *user, const superSinkEvent_t *ev )
+{
+    F &f = *(F *) user;
+
+    if constexpr( std::is_invocable<F &, const superSinkEvent_t &>::value ) return( sinkResult( f, *ev ) );
+    else
+    {
+        if( ev->value == NULL ) return(0);
+        return( sinkResult( f, *(const typename value<T>::type *) ev->value ) );
+    }
+}
+
+template<class Fmt>
+constexpr bool oneType()
+{
+    constexpr auto &f = parsed<Fmt>::f;
+    for( int i = 1 ; i < f.numArgs ; i++ ) if( f.types[i] != f.types[0] ) return( false );
+    return( true );
+}
+
+/* does every fixed arg pointer match its conversion */
+template<class Fmt, class Ptrs, class Seq> struct fixedArgs;
+template<class Fmt, class Ptrs, std::size_t... I>
+struct fixedArgs<Fmt, Ptrs, std::index_sequence<I...>>
+{
+    static constexpr bool ok = (isArray<parsed<Fmt>::f.types[I], typename std::tuple_element<I, Ptrs>::type>() && ...);
+};
+
+/* is every column of a *( ) list an array, or every one a vector, of its field's type */
+template<class Fmt, class Ptrs, class Seq> struct tupleArgs;
+template<class Fmt, class Ptrs, std::size_t... I>
+struct tupleArgs<Fmt, Ptrs, std::index_sequence<I...>>
+{
+    static constexpr bool arrays = (isArray<parsed<Fmt>::f.types[I], typename std::tuple_element<I, Ptrs>::type>() && ...);
+    static constexpr bool vectors = (isVector<parsed<Fmt>::f.types[I], typename std::tuple_element<I, Ptrs>::type>() && ...);
+};
+
+/* is every pointer of a "+" option a pointer to the T * the library grows for its field */
+template<class Fmt, class Ptrs, class Seq> struct growArgs;
+template<class Fmt, class Ptrs, std::size_t... I>
+struct growArgs<Fmt, Ptrs, std::index_sequence<I...>>
+{
+    static constexpr bool ok = (std::is_same<typename std::tuple_element<I, Ptrs>::type, typename value<parsed<Fmt>::f.types[I]>::type **>::value && ...);
+};
+
+#if SG_ENABLE_HELPSTRING
+constexpr int numHelp = 1;
+#else
+constexpr int numHelp = 0;
+#endif
+
+template<class Fmt, class... Args>
+constexpr int expectedArgs()
+{
+    constexpr auto &f = parsed<Fmt>::f;
+    return( (f.sink ? 1 : f.var || f.grow ? f.numArgs + 1 : (f.numArgs > 0 ? f.numArgs : 1)) + numHelp );
+}
+
+template<class Fmt, class... Args>
+option<(parsed<Fmt>::f.numArgs > 0 ? parsed<Fmt>::f.numArgs : 1)> makeOption( Fmt, Args... args )
+{
+    constexpr auto &f = parsed<Fmt>::f;
+    constexpr int numPtrs = f.numArgs > 0 ? f.numArgs : 1;
+    typedef std::tuple<Args...> all;
+    option<numPtrs> o = {};
+    void *ptrs[sizeof...(Args) + 1] = { toPtr( args )... };
+
+    static_assert( !f.badConversion, "supergetopt: unknown % conversion (use %c %hd %d %u %x %ld %f %lf %s %B %T)" );
+    static_assert( !f.noName, "supergetopt: option has no name" );
+    static_assert( !f.var || f.numArgs == 1 || f.tuple, "supergetopt: a * list takes exactly one % conversion, or a *( ) tuple of them" );
+    static_assert( sizeof...(Args) == expectedArgs<Fmt>(), "supergetopt: wrong number of pointers (and help string) for this format" );
+
+    if constexpr( sizeof...(Args) == expectedArgs<Fmt>() )
+    {
+        if constexpr( numHelp ) static_assert( std::is_convertible<typename std::tuple_element<sizeof...(Args) - 1, all>::type, const char *>::value,
+                                               "supergetopt: the last argument is the help string" );
+
+        if constexpr( f.sink )
+        {
+            typedef typename std::remove_pointer<typename std::tuple_element<0, all>::type>::type callable;
+            static_assert( std::is_pointer<typename std::tuple_element<0, all>::type>::value, "supergetopt: a > option takes a pointer to its sink" );
+            static_assert( std::is_invocable<callable &, const superSinkEvent_t &>::value ||
+                           (oneType<Fmt>() && std::is_invocable<callable &, typename value<f.types[0]>::type>::value),
+                           "supergetopt: a sink must take a superSinkEvent_t, or (options of one type) each value" );
+            o.bind = SG_BIND_SINK;
+            o.sink = sinkCall<callable, f.types[0]>;
+            o.sinkUser = ptrs[0];
+        }
+        else if constexpr( f.grow )
+        {
+            static_assert( growArgs<Fmt, all, std::make_index_sequence<f.numArgs>>::ok, "supergetopt: a + option binds a T ** (starting NULL) per field" );
+            static_assert( std::is_same<typename std::tuple_element<f.numArgs, all>::type, int *>::value, "supergetopt: a + option's arrays are followed by an int * count" );
+            o.pNumArgs = (int *) ptrs[f.numArgs];
+            o.bind = SG_BIND_GROW;
+        }
+        else if constexpr( f.var && f.numArgs == 1 )
+        {
+            typedef typename std::tuple_element<0, all>::type list;
+            static_assert( isArray<f.types[0], list>() || isVector<f.types[0], list>() || isViews<f.types[0], list>() || isSpan<f.types[0], list>(),
+                           "supergetopt: a * list binds an array, std::vector or std::span of its type (or std::vector<std::string_view> for %s)" );
+            static_assert( std::is_same<typename std::tuple_element<1, all>::type, int *>::value, "supergetopt: a * list is followed by an int * count" );
+            o.pNumArgs = (int *) ptrs[1];
+            o.bind = isViews<f.types[0], list>() ? SG_BIND_VIEWS : isVector<f.types[0], list>() ? SG_BIND_VECTOR : SG_BIND_ARRAY;
+            if constexpr( isSpan<f.types[0], list>() ) *o.pNumArgs = (int) std::get<0>( std::tie( args... ) ).size();
+        }
+        else if constexpr( f.var )
+        {
+            typedef tupleArgs<Fmt, all, std::make_index_sequence<f.numArgs>> columns;
+            static_assert( columns::arrays || columns::vectors, "supergetopt: a *( ) list binds an array, or a std::vector, of each field's type" );
+            static_assert( std::is_same<typename std::tuple_element<f.numArgs, all>::type, int *>::value, "supergetopt: a *( ) list's columns are followed by an int * count" );
+            o.pNumArgs = (int *) ptrs[f.numArgs];
+            o.bind = columns::vectors ? SG_BIND_VECTOR : SG_BIND_ARRAY;
+        }
+        else if constexpr( f.numArgs == 0 )
+        {
+            static_assert( std::is_same<typename std::tuple_element<0, all>::type, int *>::value, "supergetopt: an option without values binds an int *" );
+        }
+        else
+        {
+            static_assert( fixedArgs<Fmt, all, std::make_index_sequence<f.numArgs>>::ok, "supergetopt: a pointer doesn't match its % conversion" );
+        }
+    }
+
+    o.name = f.name;
+    o.types = f.types;
+    o.numArgs = f.numArgs;
+    o.varflag = f.var ? 1 : 0;
+    for( int i = 0 ; i < numPtrs ; i++ ) o.ptrs[i] = ptrs[i];
+    if constexpr( numHelp ) o.helpString = (const char *) ptrs[sizeof...(Args) - 1];
+    return( o );
+}
+
+} // namespace detail
+
+// compile options made with SG_OPT into a spec for superParseSpec and friends
+template<class... Opts>
+int compile( superOptSpec_t **pSpec, const Opts &... opts )
+{
+    const superOptDesc_t table[] = { opts.desc()... };
+    return( superCompileTable( pSpec, table, (int) sizeof...(Opts) ) );
+}
+
+} // namespace sg
+
+#endif
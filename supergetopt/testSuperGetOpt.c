@@ -98,6 +98,7 @@ int main( int argc, char *argv[] )
 			(char * ) 0 ); 
 
 	printf("Supergetopt returned %d argPos=%d helpSet=%d\n", n,argPos,helpSet);
+	argv = superArgv( &argc ); // with @file args expanded, argPos indexes this argv
 	
 	
 	// Note: n = SG_ERROR_EXTRA_ARGS just means extra args, starting at argv[argPos]
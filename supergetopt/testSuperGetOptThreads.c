@@ -0,0 +1,1069 @@
+/*********************************************************************
+
+Copyright (c) 2007-2016, Anthony P. Russo
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of Russolutions, Inc. nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*********************************************************************/
+/*********************************************************************
+    This file is part of SuperGetOpt.
+
+    SuperGetOpt is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    SuperGetOpt is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with SuperGetOpt.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+/* Stress test: many threads parse at once, through the per-thread legacy
+    calls and through their own contexts, and check every result. Then a
+    batch parse is checked record by record against the serial parse, and
+    @file expansion and config files against a few test files. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <pthread.h>
+
+#include "supergetopt.h"
+#if defined( __cplusplus ) && __cplusplus >= 201703L
+#include "supergetopt.hpp"
+#endif
+
+#define NUM_THREADS 8
+#define NUM_ITERS   20000
+
+static int failures[NUM_THREADS];
+
+static void *worker( void *arg )
+{
+    int tid = (int) (size_t) arg;
+    superOptCtx_t *ctx = superCtxNew();
+    superOptSpec_t *spec = NULL;
+    char nbuf[32], vbuf[3][32], tbuf[32];
+    int it, k, n, argPos;
+
+    int sn = 0;
+    double sv[8];
+    int snumv = 8;
+    char *sname = NULL;
+
+    if( superCompileOpt( &spec, "-n %d", &sn, "number", "-v *%lf", sv, &snumv, "values", "-name %s", &sname, "name", NULL ) < 0 )
+    {
+        failures[tid]++;
+        return( NULL );
+    }
+
+    for( it = 0 ; it < NUM_ITERS ; it++ )
+    {
+        int value = tid * 1000000 + it;
+        int num = -1;
+        double v[8];
+        int numv = 8;
+        char *name = NULL;
+        char *argv[12];
+
+        sprintf( nbuf, "%d", value );
+        sprintf( tbuf, "t%d", tid );
+        for( k = 0 ; k < 3 ; k++ ) sprintf( vbuf[k], "%d.5", value + k );
+
+        argv[0] = (char *) "prog";
+        argv[1] = (char *) "extra";
+        argv[2] = (char *) "-n";     argv[3] = nbuf;
+        argv[4] = (char *) "-v";     argv[5] = vbuf[0]; argv[6] = vbuf[1]; argv[7] = vbuf[2];
+        argv[8] = (char *) "-name";  argv[9] = tbuf;
+        argv[10] = NULL;
+
+        if( it & 1 )
+        {
+            n = superGetOpt( 10, argv, &argPos,
+                             "-n %d", &num, "number",
+                             "-v *%lf", v, &numv, "values",
+                             "-name %s", &name, "name",
+                             NULL );
+        }
+        else
+        {
+            n = superCtxParseSpec( ctx, spec, 9, argv + 1, &argPos );
+            num = sn;
+            numv = snumv;
+            memcpy( v, sv, sizeof(v) );
+            name = sname;
+        }
+
+        if( n != 1 || num != value || numv != 3 || name != tbuf || strcmp( argv[argPos], "extra" ) != 0 )
+        {
+            failures[tid]++;
+            continue;
+        }
+        for( k = 0 ; k < 3 ; k++ )
+        {
+            if( v[k] != value + k + 0.5 ) failures[tid]++;
+        }
+    }
+
+    superFreeOpt( spec );
+    superCtxFree( ctx );
+    return( NULL );
+}
+
+#define NUM_RECS 5000
+
+typedef struct
+{
+    int n;
+    double v[8];
+    int numv;
+    char *name;
+} batchOut_t;
+
+static int batchCheck( void )
+{
+    static char tokens[NUM_RECS][4][32];
+    static char *argvs[NUM_RECS][8];
+    static batchOut_t outs[NUM_RECS];
+    static superBatchRec_t recs[NUM_RECS];
+    batchOut_t tmpl = { 0 }, serial;
+    superOptSpec_t *spec = NULL;
+    int r, k, n, argPos, bad = 0;
+
+    tmpl.numv = 8;
+    if( superCompileOpt( &spec, "-n %d", &tmpl.n, "number", "-v *%lf", tmpl.v, &tmpl.numv, "values", "-name %s", &tmpl.name, "name", NULL ) < 0 ) return(1);
+
+    for( r = 0 ; r < NUM_RECS ; r++ )
+    {
+        char **av = argvs[r];
+        int ac = 0;
+
+        sprintf( tokens[r][0], (r % 97) ? "%d" : "%dx", r );      // every 97th is a bad int
+        for( k = 1 ; k < 4 ; k++ ) sprintf( tokens[r][k], "%d.25", r * k );
+        av[ac++] = (char *) "-n";    av[ac++] = tokens[r][0];
+        av[ac++] = (char *) "-v";
+        for( k = 1 ; k <= 1 + r % 3 ; k++ ) av[ac++] = tokens[r][k];
+        if( r % 5 ) { av[ac++] = (char *) "-name"; av[ac++] = tokens[r][3]; }
+        recs[r].argc = ac;
+        recs[r].argv = av;
+        recs[r].outBase = &outs[r];
+        outs[r] = tmpl;
+    }
+
+    if( superParseBatch( spec, &tmpl, sizeof(tmpl), recs, NUM_RECS, 4 ) != 0 ) bad++;
+
+    for( r = 0 ; r < NUM_RECS ; r++ )
+    {
+        tmpl.n = -1; tmpl.numv = 8; tmpl.name = NULL;
+        n = superParseSpec( spec, recs[r].argc, recs[r].argv, &argPos );
+        serial = tmpl;
+        if( n != recs[r].status || argPos != recs[r].lastArg ) { bad++; continue; }
+        if( n < 0 ) continue;
+        if( serial.n != outs[r].n || serial.numv != outs[r].numv || serial.name != outs[r].name ) bad++;
+        for( k = 0 ; k < serial.numv ; k++ ) if( serial.v[k] != outs[r].v[k] ) bad++;
+    }
+
+    if( superParseBatch( spec, &tmpl, sizeof(int), recs, NUM_RECS, 4 ) != SG_ERROR_BAD_BINDING ) bad++;
+    superFreeOpt( spec );
+
+    /* the workers parse with this thread's modes: prefixes of names, and the environment */
+    if( superCompileOpt( &spec, "--number %d", &tmpl.n, "number", "-v *%lf", tmpl.v, &tmpl.numv, "values", NULL ) < 0 ) return(1);
+    superSetNameMode( SG_NAMES_PREFIX );
+    superSetEnvPrefix( "SGBATCH_" );
+    setenv( "SGBATCH_V", "1.5 2.5", 1 );
+    for( r = 0 ; r < 64 ; r++ )
+    {
+        sprintf( tokens[r][0], "%d", r );
+        argvs[r][0] = (char *) "--num";
+        argvs[r][1] = tokens[r][0];
+        recs[r].argc = 2;
+        recs[r].argv = argvs[r];
+        recs[r].outBase = &outs[r];
+        outs[r] = tmpl;
+    }
+    if( superParseBatch( spec, &tmpl, sizeof(tmpl), recs, 64, 4 ) != 0 ) bad++;
+    for( r = 0 ; r < 64 ; r++ )
+    {
+        if( recs[r].status != 0 || outs[r].n != r || outs[r].numv != 2 || outs[r].v[1] != 2.5 ) bad++;
+    }
+    unsetenv( "SGBATCH_V" );
+    superSetEnvPrefix( NULL );
+    superSetNameMode( SG_NAMES_EXACT );
+    superFreeOpt( spec );
+    printf("batch of %d records: %d mismatches\n", NUM_RECS, bad);
+    return( bad );
+}
+
+static void writeFile( const char *name, const char *text, size_t len )
+{
+    FILE *fp = fopen( name, "wb" );
+
+    if( fp == NULL ) return;
+    fwrite( text, 1, len, fp );
+    fclose( fp );
+}
+
+static int rspCheck( void )
+{
+    static char page[4096];
+    char *argv[] = { (char *) "prog", (char *) "@sgTestOuter.rsp", (char *) "tail", NULL };
+    char *cyc[] = { (char *) "prog", (char *) "-n", (char *) "1", (char *) "@sgTestCycA.rsp", NULL };
+    char *pg[] = { (char *) "@sgTestPage.rsp", NULL };
+    char **xargv;
+    int xargc, n, argPos, bad = 0;
+    int num = 0;
+    double v[8];
+    int numv = 8;
+    char *name = NULL;
+    const char *outer = "-n 42\n  -v 1.5 @sgTestInner.rsp -name \"two words\" extra\\ one\n";
+    const char *inner = "2.5 '3.5'";
+
+    writeFile( "sgTestOuter.rsp", outer, strlen( outer ) );
+    writeFile( "sgTestInner.rsp", inner, strlen( inner ) );
+    writeFile( "sgTestCycA.rsp", "@sgTestCycB.rsp", 15 );
+    writeFile( "sgTestCycB.rsp", "@sgTestCycA.rsp", 15 );
+    memset( page, 'x', sizeof(page) );
+    memcpy( page, "-name ", 6 );          // last token runs to the page aligned end of the file
+    writeFile( "sgTestPage.rsp", page, sizeof(page) );
+
+    n = superGetOpt( 3, argv, &argPos, "-n %d", &num, "number", "-v *%lf", v, &numv, "values", "-name %s", &name, "name", NULL );
+    xargv = superArgv( &xargc );
+    if( n != 2 || num != 42 || numv != 3 || v[0] != 1.5 || v[1] != 2.5 || v[2] != 3.5 ) bad++;
+    if( name == NULL || strcmp( name, "two words" ) != 0 ) bad++;
+    if( xargc != 11 || strcmp( xargv[argPos], "extra one" ) != 0 || strcmp( xargv[argPos+1], "tail" ) != 0 ) bad++;
+
+    n = superGetOpt( 4, cyc, &argPos, "-n %d", &num, "number", NULL );
+    if( n != SG_ERROR_RESPONSE_FILE || argPos != 3 ) bad++;
+
+    n = superParseOpt( 1, pg, &argPos, "-name %s", &name, "name", NULL );
+    if( n != 0 || name == NULL || strlen( name ) != sizeof(page) - 6 ) bad++;
+
+    remove( "sgTestOuter.rsp" );
+    remove( "sgTestInner.rsp" );
+    remove( "sgTestCycA.rsp" );
+    remove( "sgTestCycB.rsp" );
+    remove( "sgTestPage.rsp" );
+
+    printf("response files: %d failures\n", bad);
+    return( bad );
+}
+
+static int fileCheck( void )
+{
+    const char *cfg = "# comment\nthreads 8\r\n--values 1.5 2.5 \\\n  3.5 # the rest\n\n-name \"two words\"\n";
+    const char *badCfg = "threads 8\n\nthreads 9 10\n";
+    superOptSpec_t *spec = NULL;
+    int threads = 0, numv = 8, line = -1, n, bad = 0;
+    double v[8];
+    char *name = NULL;
+
+    writeFile( "sgTestGood.cfg", cfg, strlen( cfg ) );
+    writeFile( "sgTestBad.cfg", badCfg, strlen( badCfg ) );
+
+    if( superCompileOpt( &spec, "-threads %d", &threads, "threads", "--values *%lf", v, &numv, "values", "-name %s", &name, "name", NULL ) < 0 ) return(1);
+
+    n = superParseFile( spec, "sgTestGood.cfg", &line );
+    if( n != 0 || line != 0 || threads != 8 || numv != 3 || v[0] != 1.5 || v[2] != 3.5 ) bad++;
+    if( name == NULL || strcmp( name, "two words" ) != 0 ) bad++;
+
+    n = superParseFile( spec, "sgTestBad.cfg", &line );
+    if( n != SG_ERROR_UNKNOWN_ARG || line != 3 ) bad++;
+
+    superFreeOpt( spec );
+    remove( "sgTestGood.cfg" );
+    remove( "sgTestBad.cfg" );
+
+    printf("config files: %d failures\n", bad);
+    return( bad );
+}
+
+static int tableCheck( void )
+{
+    static const int threadTypes[] = { SG_TYPE_INT };
+    static const int valueTypes[] = { SG_TYPE_DOUBLE };
+    superOptSpec_t *spec = NULL;
+    int threads = 0, numv = 8, lastArg, n, bad = 0;
+    double v[8];
+    void *threadPtrs[] = { &threads }, *valuePtrs[] = { v };
+    superOptDesc_t table[] = { { "-threads", 0, 1, threadTypes, threadPtrs, NULL, SG_BIND_ARRAY, "threads" },
+                               { "-v", 1, 1, valueTypes, valuePtrs, &numv, SG_BIND_ARRAY, "values" } };
+    char *args[] = { (char *) "-v", (char *) "1.5", (char *) "2.5", (char *) "-threads", (char *) "4" };
+
+    if( superCompileTable( &spec, table, 2 ) < 0 ) return(1);
+    n = superParseSpec( spec, 5, args, &lastArg );
+    if( n != 0 || threads != 4 || numv != 2 || v[1] != 2.5 ) bad++;
+    superFreeOpt( spec );
+
+#if defined( __cplusplus ) && __cplusplus >= 201703L
+    {
+        std::vector<int> vi;
+        std::vector<long> vl;
+        std::vector<std::string_view> vs;
+        int numVi = 0, numVl = 0, numVs = 0, help = 0;
+        char *cppArgs[] = { (char *) "--ints", (char *) "7", (char *) "8", (char *) "-help", (char *) "-l", (char *) "-3000000000",
+                            (char *) "-s", (char *) "one", (char *) "two", (char *) "three" };
+
+        if( sg::compile( &spec, SG_OPT( "--ints *%d", &vi, &numVi, "ints" ), SG_OPT( "-help", &help, "help" ),
+                                SG_OPT( "-l *%ld", &vl, &numVl, "longs" ), SG_OPT( "-s *%s", &vs, &numVs, "views" ) ) < 0 ) return(1);
+        n = superParseSpec( spec, 10, cppArgs, &lastArg );
+        if( n != 0 || help != 1 || numVi != 2 || vi.size() != 2 || vi[1] != 8 ) bad++;
+        if( vl.size() != 1 || vl[0] != -3000000000L || vs.size() != 3 || vs[2] != "three" || vs.capacity() != 3 ) bad++;
+        superFreeOpt( spec );
+    }
+#endif
+
+    printf("option tables: %d failures\n", bad);
+    return( bad );
+}
+
+static int statsCheck( void )
+{
+    superOptStats_t st;
+    int x = 0, lastArg, n, bad = 0;
+    char *args[] = { (char *) "-x", (char *) "5", (char *) "-x", (char *) "five" };
+
+    superResetStats();
+    n = superParseOpt( 2, args, &lastArg, "-x %d", &x, "x", NULL );
+    if( n != 0 || x != 5 ) bad++;
+    n = superParseOpt( 2, args + 2, &lastArg, "-x %d", &x, "x", NULL );
+    if( n != SG_ERROR_INCORRECT_ARG ) bad++;
+
+    if( superGetStats( &st ) == 0 )
+    {
+        if( st.tokens != 4 || st.lookups < 2 || st.badConversions != 1 || st.formatNs == 0 ) bad++;
+        printf("stats: %d failures\n", bad);
+    }
+    else
+    {
+        if( st.tokens != 0 || st.lookups != 0 ) bad++;
+        printf("stats (not built in): %d failures\n", bad);
+    }
+    return( bad );
+}
+
+/* extra args scattered between options: grouped in order at the end, or left in place as spans */
+static int extrasCheck( void )
+{
+    static const char *grouped[] = { "-d", "1", "-f", "-d", "2", "a", "b", "c", "d", "e" };
+    const superArgSpan_t *spans;
+    int d = 0, f = 0, lastArg, n, i, numSpans, bad = 0;
+    char *args[10];
+    char *orig[] = { (char *) "a", (char *) "-d", (char *) "1", (char *) "b", (char *) "c",
+                     (char *) "-f", (char *) "d", (char *) "-d", (char *) "2", (char *) "e" };
+
+#if SG_GROUP_UNACC_ARGS
+    memcpy( args, orig, sizeof(orig) );
+    n = superParseOpt( 10, args, &lastArg, "-d %d", &d, "d", "-f", &f, "f", NULL );
+    if( n != 5 || lastArg != 6 || d != 2 || f != 1 ) bad++;
+    for( i = 0 ; i < 10 ; i++ ) if( strcmp( args[i], grouped[i] ) != 0 ) bad++;
+    spans = superExtraSpans( &numSpans );
+    if( numSpans != 1 || spans[0].start != 6 || spans[0].count != 5 ) bad++;
+#else
+    (void) grouped;
+    (void) i;
+#endif
+
+    superSetExtrasMode( SG_EXTRAS_SPANS );
+    memcpy( args, orig, sizeof(orig) );
+    n = superParseOpt( 10, args, &lastArg, "-d %d", &d, "d", "-f", &f, "f", NULL );
+    if( n != 5 || lastArg != 1 || memcmp( args, orig, sizeof(orig) ) != 0 ) bad++;
+    spans = superExtraSpans( &numSpans );
+    if( numSpans != 4 || spans[0].start != 1 || spans[1].start != 4 || spans[1].count != 2 || spans[3].start != 10 ) bad++;
+    superSetExtrasMode( SG_EXTRAS_GROUP );
+
+    printf("extra args: %d failures\n", bad);
+    return( bad );
+}
+
+struct sinkSum
+{
+    double sum;
+    int values, ends, stopAt;
+};
+
+static int sumSink( void *user, const superSinkEvent_t *event )
+{
+    struct sinkSum *t = (struct sinkSum *) user;
+
+    if( event->value == NULL ) t->ends++;
+    else if( event->type == SG_TYPE_DOUBLE ) t->sum += *(const double *) event->value;
+    else if( event->type == SG_TYPE_INT ) t->sum += *(const int *) event->value;
+    else if( event->type == SG_TYPE_STRING ) t->sum += strlen( *(char * const *) event->value );
+    if( event->value != NULL && ++t->values == t->stopAt ) return( SG_ERROR_INCORRECT_ARG );
+    return(0);
+}
+
+static int sinkCheck( void )
+{
+    struct sinkSum t = { 0, 0, 0, 0 };
+    int lastArg, n, bad = 0;
+    char *args[] = { (char *) "-v", (char *) "1", (char *) "2.5", (char *) "-p", (char *) "3", (char *) "abcd",
+                     (char *) "x", (char *) "-v", (char *) "4" };
+
+    n = superParseOpt( 9, args, &lastArg, "-v >*%lf", sumSink, &t, "v", "-p >%d %s", sumSink, &t, "p", NULL );
+    if( n != 1 || t.sum != 14.5 || t.values != 5 || t.ends != 3 ) bad++;
+
+    memset( &t, 0, sizeof(t) );
+    t.stopAt = 2;
+    n = superParseOpt( 9, args, &lastArg, "-v >*%lf", sumSink, &t, "v", "-p >%d %s", sumSink, &t, "p", NULL );
+    if( n != SG_ERROR_INCORRECT_ARG || t.values != 2 || t.ends != 0 ) bad++;
+
+    /* attached first values: "-v=1 2.5" is -v 1 2.5, "-p=3 abcd" is -p 3 abcd */
+    {
+        char *attached[] = { (char *) "-v=1", (char *) "2.5", (char *) "-p=3", (char *) "abcd" };
+
+        memset( &t, 0, sizeof(t) );
+        n = superParseOpt( 4, attached, &lastArg, "-v >*%lf", sumSink, &t, "v", "-p >%d %s", sumSink, &t, "p", NULL );
+        if( n != 0 || t.sum != 10.5 || t.values != 4 || t.ends != 2 ) bad++;
+    }
+
+#if defined( __cplusplus ) && __cplusplus >= 201703L
+    {
+        superOptSpec_t *spec;
+        double sum = 0;
+        int ends = 0;
+        auto add = [&]( double v ) { sum += v; };
+        auto count = [&]( const superSinkEvent_t &ev ) { if( ev.value == NULL ) ends++; };
+
+        if( sg::compile( &spec, SG_OPT( "-v >*%lf", &add, "v" ), SG_OPT( "-p >%d %s", &count, "p" ) ) != 0 ) bad++;
+        else
+        {
+            n = superParseSpec( spec, 9, args, &lastArg );
+            if( n != 1 || sum != 7.5 || ends != 1 ) bad++;
+            superFreeOpt( spec );
+        }
+    }
+#endif
+
+    printf("sinks: %d failures\n", bad);
+    return( bad );
+}
+
+static int lazyCheck( void )
+{
+    superOptSpec_t *spec;
+    superLazy_t *lazy;
+    const superArgSpan_t *spans;
+    double v[4];
+    int n = 7, numv = 4, q = 0, lastArg, numSpans, r, bad = 0;
+    char *name = NULL;
+    char *args[] = { (char *) "extra", (char *) "-v", (char *) "1", (char *) "2", (char *) "-n", (char *) "x",
+                     (char *) "-name", (char *) "bob", (char *) "more" };
+
+    if( superCompileOpt( &spec, "-n %d", &n, "n", "-v *%lf", v, &numv, "v", "-name %s", &name, "name", "-q", &q, "q", NULL ) < 0 )
+    {
+        printf("lazy parsing: compile failed\n");
+        return(1);
+    }
+
+    r = superParseLazy( spec, 9, args, &lastArg, &lazy );
+    spans = superLazyExtraSpans( lazy, &numSpans );
+    if( r != 2 || lastArg != 1 || numSpans != 2 || spans[1].start != 9 ) bad++;
+    if( n != 7 || numv != 4 || name != NULL ) bad++;       /* nothing converted yet */
+
+    if( superLazyGet( lazy, "-v", &lastArg ) != 2 || numv != 2 || v[1] != 2.0 || n != 7 ) bad++;
+    if( superLazyGet( lazy, "-name", &lastArg ) != 1 || strcmp( name, "bob" ) != 0 ) bad++;
+    if( superLazyGet( lazy, "-q", &lastArg ) != 0 || q != 0 ) bad++;
+    r = superLazyGet( lazy, "-n", &lastArg );
+    if( r != SG_ERROR_INCORRECT_ARG || superLazyGet( lazy, "-n", &lastArg ) != r || lastArg < 5 ) bad++;
+    if( superLazyGet( lazy, "-nope", &lastArg ) != SG_ERROR_UNKNOWN_ARG ) bad++;
+    superFreeLazy( lazy );
+
+    if( superParseLazy( spec, 2, args + 3, &lastArg, &lazy ) != SG_ERROR_MISSING_ARG || lazy != NULL ) bad++;
+
+    /* values attached with '=', and a * list that ends at one */
+    {
+        char *attached[] = { (char *) "-v=1", (char *) "2", (char *) "-n=5", (char *) "-name=al", (char *) "more" };
+
+        if( superParseLazy( spec, 5, attached, &lastArg, &lazy ) != 1 || lastArg != 5 ) bad++;
+        if( superLazyGet( lazy, "-v", &lastArg ) != 2 || numv != 2 || v[0] != 1.0 || v[1] != 2.0 ) bad++;
+        if( superLazyGet( lazy, "-n", &lastArg ) != 1 || n != 5 || superLazyGet( lazy, "-name", &lastArg ) != 1 || strcmp( name, "al" ) != 0 ) bad++;
+        superFreeLazy( lazy );
+    }
+    superFreeOpt( spec );
+
+    printf("lazy parsing: %d failures\n", bad);
+    return( bad );
+}
+
+static int watchCheck( void )
+{
+    const char *cfg[] = { "threads 8\nname a\n", "threads 8\nname b\nvalues 1 2\n", "threads 9 10\n", "threads 8\n" };
+    superOptSpec_t *spec = NULL;
+    superWatch_t *watch;
+    const char *const *changed;
+    int threads = 1, numv = 8, line, n, numChanged, bad = 0;
+    double v[8];
+    char *name = NULL;
+
+    if( superCompileOpt( &spec, "-threads %d", &threads, "threads", "--values *%lf", v, &numv, "values", "-name %s", &name, "name", NULL ) < 0 ) return(1);
+
+    writeFile( "sgTestWatch.cfg", cfg[0], strlen( cfg[0] ) );
+    if( superWatchOpen( &watch, spec, "sgTestWatch.cfg" ) != 0 )
+    {
+        printf("config reload: open failed\n");
+        return(1);
+    }
+
+    n = superWatchCheck( watch, &line );
+    changed = superWatchChanged( watch, &numChanged );
+    if( n != 2 || numChanged != 2 || strcmp( changed[0], "-threads" ) != 0 || strcmp( changed[1], "-name" ) != 0 ) bad++;
+    if( threads != 8 || name == NULL || strcmp( name, "a" ) != 0 || numv != 0 ) bad++;
+    if( superWatchCheck( watch, &line ) != 0 ) bad++;     /* untouched */
+
+    writeFile( "sgTestWatch.cfg", cfg[1], strlen( cfg[1] ) );
+    n = superWatchCheck( watch, &line );
+    changed = superWatchChanged( watch, &numChanged );
+    if( n != 2 || strcmp( changed[0], "--values" ) != 0 || strcmp( changed[1], "-name" ) != 0 || numv != 2 || strcmp( name, "b" ) != 0 ) bad++;
+
+    writeFile( "sgTestWatch.cfg", cfg[2], strlen( cfg[2] ) );
+    n = superWatchCheck( watch, &line );
+    if( n != SG_ERROR_UNKNOWN_ARG || line != 1 || threads != 8 || numv != 2 || v[1] != 2.0 || strcmp( name, "b" ) != 0 ) bad++;
+
+    writeFile( "sgTestWatch.cfg", cfg[3], strlen( cfg[3] ) );
+    n = superWatchCheck( watch, &line );
+    if( n != 2 || numv != 0 || name != NULL || threads != 8 ) bad++;
+    superWatchClose( watch );
+
+    /* a string the file never sets keeps the caller's pointer, past the close */
+    {
+        char dflt[] = "default";
+
+        name = dflt;
+        writeFile( "sgTestWatch.cfg", "threads 4\n", 10 );
+        if( superWatchOpen( &watch, spec, "sgTestWatch.cfg" ) != 0 ) return(1);
+        if( superWatchCheck( watch, &line ) != 1 || threads != 4 || name != dflt ) bad++;
+        writeFile( "sgTestWatch.cfg", "threads 5\n", 10 );
+        if( superWatchCheck( watch, &line ) != 1 || threads != 5 || name != dflt ) bad++;
+        superWatchClose( watch );
+        if( name != dflt || strcmp( name, "default" ) != 0 ) bad++;
+    }
+
+    /* polling sees a rewrite in the same second, to the same length */
+    writeFile( "sgTestWatch.cfg", "threads 4\n", 10 );
+    if( superWatchOpen( &watch, spec, "sgTestWatch.cfg" ) != 0 ) return(1);
+    superWatchPoll( watch );
+    if( superWatchFd( watch ) != -1 || superWatchCheck( watch, &line ) != 1 || threads != 4 ) bad++;
+    if( superWatchCheck( watch, &line ) != 0 ) bad++;
+    writeFile( "sgTestWatch.cfg", "threads 5\n", 10 );
+    if( superWatchCheck( watch, &line ) != 1 || threads != 5 ) bad++;
+    superWatchClose( watch );
+
+    superFreeOpt( spec );
+    remove( "sgTestWatch.cfg" );
+
+    printf("config reload: %d failures\n", bad);
+    return( bad );
+}
+
+static int nameCheck( void )
+{
+    superOptSpec_t *spec = NULL;
+    const char *names[4];
+    double v[4];
+    int verbose = 0, version = 0, n = 0, numv = 4, lastArg, r, bad = 0;
+    char *args[] = { (char *) "--vers", (char *) "3", (char *) "--val", (char *) "1", (char *) "2", (char *) "--verb",
+                     (char *) "-n", (char *) "4" };
+    char *amb[] = { (char *) "-n", (char *) "1", (char *) "--ve" };
+
+    if( superCompileOpt( &spec, "--verbose", &verbose, "v", "--version %d", &version, "version", "--values *%lf", v, &numv, "values",
+                         "-n %d", &n, "n", NULL ) < 0 ) return(1);
+
+    if( superParseSpec( spec, 8, args, &lastArg ) != SG_ERROR_UNKNOWN_ARG ) bad++;    /* exact names by default */
+
+    superSetNameMode( SG_NAMES_PREFIX );
+    r = superParseSpec( spec, 8, args, &lastArg );
+    if( r != 0 || verbose != 1 || version != 3 || numv != 2 || v[1] != 2.0 || n != 4 ) bad++;
+    if( superParseSpec( spec, 3, amb, &lastArg ) != SG_ERROR_AMBIGUOUS_ARG || lastArg != 3 ) bad++;
+
+    /* a lazy handle takes the thread's name mode too */
+    {
+        superLazy_t *lazy;
+
+        version = 0;
+        numv = 4;
+        if( superParseLazy( spec, 8, args, &lastArg, &lazy ) != 0 ) bad++;
+        else
+        {
+            if( superLazyGet( lazy, "--vers", &lastArg ) != 1 || version != 3 || superLazyGet( lazy, "--val", &lastArg ) != 2 || numv != 2 ) bad++;
+            superFreeLazy( lazy );
+        }
+        superSetDiagMode( SG_DIAG_QUIET );
+        if( superParseLazy( spec, 3, amb, &lastArg, &lazy ) != SG_ERROR_AMBIGUOUS_ARG || lastArg != 3 || lazy != NULL ) bad++;
+        superSetDiagMode( SG_DIAG_STDERR );
+    }
+    superSetNameMode( SG_NAMES_EXACT );
+
+    if( superCompleteSpec( spec, "--ve", names, 4 ) != 2 || strcmp( names[0], "--verbose" ) != 0 || strcmp( names[1], "--version" ) != 0 ) bad++;
+    if( superCompleteSpec( spec, "--v", names, 1 ) != 3 || strcmp( names[0], "--values" ) != 0 ) bad++;
+    if( superCompleteSpec( spec, "", NULL, 0 ) != 4 || superCompleteSpec( spec, "--x", names, 4 ) != 0 ) bad++;
+    superFreeOpt( spec );
+
+    printf("name prefixes: %d failures\n", bad);
+    return( bad );
+}
+
+static int usageCheck( void )
+{
+    const char *expect = "***** Usage *****\n"
+                         "  -n int  number of worker threads to\n"
+                         "          start\n"
+                         "  -v double [double, ...]\n"
+                         "          values\n"
+                         "  -q\n";
+    superOptSpec_t *spec = NULL;
+    const char *text, *wide;
+    double v[4];
+    int n = 0, numv = 4, q = 0, bad = 0;
+    size_t len;
+
+    if( superCompileOpt( &spec, "-n %d", &n, "number of worker threads to start", "-v *%lf", v, &numv, "values", "-q", &q, "", NULL ) < 0 ) return(1);
+
+    text = superUsageText( spec, 40, &len );
+    if( text == NULL || len != strlen( expect ) || strcmp( text, expect ) != 0 ) bad++;
+    wide = superUsageText( spec, 100, &len );
+    if( wide == NULL || wide == text || strstr( wide, "  -n int                   number of worker threads to start\n" ) == NULL ) bad++;
+    if( superUsageText( spec, 40, &len ) != text ) bad++;        /* kept */
+    superFreeOpt( spec );
+
+    printf("usage text: %d failures\n", bad);
+    return( bad );
+}
+
+static int diagCheck( void )
+{
+    superOptSpec_t *spec = NULL;
+    const superDiag_t *d;
+    char text[128];
+    int v[2], numv = 2, n = 0, w = 0, lastArg, bad = 0;
+    char *badInt[] = { (char *) "-n", (char *) "4", (char *) "-n", (char *) "4x" };
+    char *excess[] = { (char *) "-v", (char *) "1", (char *) "2", (char *) "3", (char *) "4", (char *) "-w" };
+    char *unknown[] = { (char *) "-n", (char *) "1", (char *) "--nope" };
+
+    if( superCompileOpt( &spec, "-n %d", &n, "n", "-v *%d", v, &numv, "v", "-w", &w, "w", NULL ) < 0 ) return(1);
+    superSetDiagMode( SG_DIAG_QUIET );
+
+    if( superParseSpec( spec, 4, badInt, &lastArg ) != SG_ERROR_INCORRECT_ARG ) bad++;
+    d = superLastDiag();
+    if( d->code != SG_ERROR_INCORRECT_ARG || d->argIndex != 4 || d->option == NULL || strcmp( d->option, "-n" ) != 0 ||
+        d->expectedType != SG_TYPE_INT || strcmp( d->token, "4x" ) != 0 ) bad++;
+    superFormatDiag( d, text, sizeof(text) );
+    if( strcmp( text, "arg 4 <4x>: incorrect argument for -n (expected integer)" ) != 0 ) bad++;
+    if( superFormatDiag( d, text, 8 ) != 56 || strcmp( text, "arg 4 <" ) != 0 ) bad++;
+
+    /* values past the array are counted, and the list still ends at -w */
+    if( superParseSpec( spec, 6, excess, &lastArg ) != 0 || numv != 2 || v[1] != 2 || w != 1 ) bad++;
+    if( d->code != 0 || d->dropped != 2 || strcmp( d->droppedOption, "-v" ) != 0 ) bad++;
+    superFormatDiag( d, text, sizeof(text) );
+    if( strcmp( text, "2 values past the end of -v ignored" ) != 0 ) bad++;
+
+    if( superParseSpec( spec, 3, unknown, &lastArg ) != SG_ERROR_UNKNOWN_ARG ) bad++;
+    if( d->code != SG_ERROR_UNKNOWN_ARG || d->argIndex != 3 || d->option != NULL || strcmp( d->token, "--nope" ) != 0 || d->dropped != 0 ) bad++;
+
+    /* a bad format is a diag too, with the format as the token */
+    {
+        superOptSpec_t *badSpec = NULL;
+
+        if( superCompileOpt( &badSpec, "-n %d", &n, "n", "-q %q", &n, "q", NULL ) != SG_ERROR_BAD_FORMAT_TYPE || badSpec != NULL ) bad++;
+        if( d->code != SG_ERROR_BAD_FORMAT_TYPE || strcmp( d->token, "-q %q" ) != 0 ) bad++;
+        if( superParseOpt( 2, badInt, &lastArg, "-n %", &n, "n", NULL ) != SG_ERROR_NO_FORMATS || lastArg != 0 ) bad++;
+        if( d->code != SG_ERROR_NO_FORMATS || strcmp( d->token, "-n %" ) != 0 ) bad++;
+    }
+
+    superSetDiagMode( SG_DIAG_STDERR );
+    superFreeOpt( spec );
+
+    printf("diagnostics: %d failures\n", bad);
+    return( bad );
+}
+
+static int envCheck( void )
+{
+    superOptSpec_t *spec = NULL;
+    superOptCtx_t *ctx = superCtxNew();
+    const superDiag_t *d;
+    char *name = NULL, *first;
+    int threads = 1, verbose = 0, v[4], numv = 4, lastArg, bad = 0;
+    char *args[] = { (char *) "-threads", (char *) "8" };
+
+    if( ctx == NULL || superCompileOpt( &spec, "-threads %d", &threads, "t", "--verbose", &verbose, "v", "-name %s", &name, "n",
+                                        "-v *%d", v, &numv, "v", NULL ) < 0 ) return(1);
+    superCtxSetDiagMode( ctx, SG_DIAG_QUIET );
+    setenv( "SGTEST_THREADS", "4", 1 );
+    setenv( "SGTEST_VERBOSE", "1", 1 );
+    setenv( "SGTEST_NAME", "two words", 1 );
+    setenv( "SGTEST_V", " 5 6  7 ", 1 );
+
+    if( superCtxParseSpec( ctx, spec, 0, NULL, &lastArg ) != 0 || threads != 1 || verbose != 0 ) bad++;     /* off by default */
+
+    superCtxSetEnvPrefix( ctx, "SGTEST_" );
+    if( superCtxParseSpec( ctx, spec, 2, args, &lastArg ) != 0 ) bad++;
+    if( threads != 8 || verbose != 1 || name == NULL || strcmp( name, "two words" ) != 0 || numv != 3 || v[2] != 7 ) bad++;
+    if( superCtxParseSpec( ctx, spec, 0, NULL, &lastArg ) != 0 || threads != 4 ) bad++;
+
+    /* a single %s points into environ, so the next parse doesn't change it */
+    if( name != getenv( "SGTEST_NAME" ) ) bad++;
+    first = name;
+    setenv( "SGTEST_NAME", "other", 1 );
+    if( superCtxParseSpec( ctx, spec, 2, args, &lastArg ) != 0 ) bad++;
+    if( strcmp( first, "two words" ) != 0 || strcmp( name, "other" ) != 0 ) bad++;
+
+    setenv( "SGTEST_THREADS", "lots", 1 );
+    if( superCtxParseSpec( ctx, spec, 0, NULL, &lastArg ) != SG_ERROR_INCORRECT_ARG || lastArg != 0 ) bad++;
+    d = superCtxLastDiag( ctx );
+    if( d->source == NULL || strcmp( d->source, "SGTEST_THREADS" ) != 0 || strcmp( d->token, "lots" ) != 0 ) bad++;
+
+    unsetenv( "SGTEST_THREADS" );
+    unsetenv( "SGTEST_VERBOSE" );
+    unsetenv( "SGTEST_NAME" );
+    unsetenv( "SGTEST_V" );
+    superCtxFree( ctx );
+    superFreeOpt( spec );
+
+    printf("environment: %d failures\n", bad);
+    return( bad );
+}
+
+static int attachedCheck( void )
+{
+    superOptSpec_t *spec = NULL;
+    char *file = NULL, *names[4];
+    int x = 0, v = 0, n = 0, threads = 0, verbose = 0, vals[4], numv = 4, numNames = 4, lastArg, bad = 0;
+    char *args[] = { (char *) "-xvf", (char *) "out.txt", (char *) "--threads=8", (char *) "-n5" };
+    char *lists[] = { (char *) "-vals=1", (char *) "2", (char *) "3", (char *) "-xn", (char *) "4",
+                      (char *) "-names", (char *) "a", (char *) "b", (char *) "--threads=2" };
+    char *unknown[] = { (char *) "-xq" };
+    char *flagValue[] = { (char *) "--verbose=1" };
+
+    if( superCompileOpt( &spec, "-x", &x, "x", "-v", &v, "v", "-f %s", &file, "f", "-n %d", &n, "n", "--threads %d", &threads, "t",
+                         "--verbose", &verbose, "verbose", "-vals *%d", vals, &numv, "vals", "-names *%s", names, &numNames, "names", NULL ) < 0 ) return(1);
+
+    if( superParseSpec( spec, 4, args, &lastArg ) != 0 ) bad++;
+    if( x != 1 || v != 1 || file == NULL || strcmp( file, "out.txt" ) != 0 || threads != 8 || n != 5 ) bad++;
+    if( strcmp( args[2], "--threads=8" ) != 0 || strcmp( args[3], "-n5" ) != 0 ) bad++;      /* argv as it was */
+
+    x = n = 0;
+    if( superParseSpec( spec, 9, lists, &lastArg ) != 0 ) bad++;
+    if( numv != 3 || vals[2] != 3 || x != 1 || n != 4 || numNames != 2 || strcmp( names[1], "b" ) != 0 || threads != 2 ) bad++;
+
+    x = 0;
+    superSetDiagMode( SG_DIAG_QUIET );
+    if( superParseSpec( spec, 1, unknown, &lastArg ) != SG_ERROR_UNKNOWN_ARG || x != 0 ) bad++;    /* all of a bundle or none */
+    if( superParseSpec( spec, 1, flagValue, &lastArg ) != SG_ERROR_INCORRECT_ARG || lastArg != 1 ) bad++;
+    if( strcmp( superLastDiag()->token, "1" ) != 0 ) bad++;
+    superSetDiagMode( SG_DIAG_STDERR );
+    superFreeOpt( spec );
+
+    printf("attached values and bundles: %d failures\n", bad);
+    return( bad );
+}
+
+static int convertCheck( void )
+{
+    char *huge[] = { (char *) "-d", (char *) "1e700000" };
+    char *big[] = { (char *) "-f", (char *) "1e39" };
+    char *inf[] = { (char *) "-d", (char *) "-inf", (char *) "-f", (char *) "inf" };
+    char *edge[] = { (char *) "-d", (char *) "1.7976931348623157e308", (char *) "-f", (char *) "3.4028234e38" };
+    char *tiny[] = { (char *) "-d", (char *) "1e-700000", (char *) "-f", (char *) "-1e-700000" };
+    double d = 1;
+    float f = 1;
+    int lastArg, bad = 0;
+
+    /* a finite value past the range is an error, however far past; inf spelled out is not */
+    superSetDiagMode( SG_DIAG_QUIET );
+    if( superParseOpt( 2, huge, &lastArg, "-d %lf", &d, "d", NULL ) != SG_ERROR_INCORRECT_ARG ) bad++;
+    if( superParseOpt( 2, big, &lastArg, "-f %f", &f, "f", NULL ) != SG_ERROR_INCORRECT_ARG ) bad++;
+    superSetDiagMode( SG_DIAG_STDERR );
+    if( superParseOpt( 4, edge, &lastArg, "-d %lf", &d, "d", "-f %f", &f, "f", NULL ) != 0 || d != DBL_MAX || f != FLT_MAX ) bad++;
+    if( superParseOpt( 4, inf, &lastArg, "-d %lf", &d, "d", "-f %f", &f, "f", NULL ) != 0 || !(d < -DBL_MAX) || !(f > FLT_MAX) ) bad++;
+    /* one too small for the type is 0 */
+    if( superParseOpt( 4, tiny, &lastArg, "-d %lf", &d, "d", "-f %f", &f, "f", NULL ) != 0 || d != 0.0 || f != 0.0f ) bad++;
+
+    printf("number conversions: %d failures\n", bad);
+    return( bad );
+}
+
+static int unitsCheck( void )
+{
+    superOptSpec_t *spec = NULL;
+    unsigned long long cache = 0, sizes[4];
+    long long timeout = 0, times[4];
+    int numSizes = 4, numTimes = 4, lastArg, bad = 0;
+    char *args[] = { (char *) "-cache", (char *) "4G", (char *) "-timeout", (char *) "250ms",
+                     (char *) "-sizes", (char *) "64Ki", (char *) "1.5MiB", (char *) "512", (char *) "18446744073709551615B",
+                     (char *) "-times", (char *) "1h30m", (char *) "-1.5s", (char *) "0", (char *) "1.000000001s" };
+    char *bad1[] = { (char *) "-cache", (char *) "16Ei" };
+    char *bad2[] = { (char *) "-timeout", (char *) "5" };
+    char *bad3[] = { (char *) "-timeout", (char *) "9223372036854775808ns" };
+    char *edge[] = { (char *) "-timeout", (char *) "-9223372036854775808ns", (char *) "-cache", (char *) "15.999999999999999999Ei" };
+
+    if( superCompileOpt( &spec, "-cache %B", &cache, "cache size", "-timeout %T", &timeout, "timeout",
+                         "-sizes *%B", sizes, &numSizes, "sizes", "-times *%T", times, &numTimes, "times", NULL ) < 0 ) return(1);
+
+    if( superParseSpec( spec, 14, args, &lastArg ) != 0 ) bad++;
+    if( cache != 4000000000ULL || timeout != 250000000LL ) bad++;
+    if( numSizes != 4 || sizes[0] != 65536 || sizes[1] != 1572864 || sizes[2] != 512 || sizes[3] != 18446744073709551615ULL ) bad++;
+    if( numTimes != 4 || times[0] != 5400000000000LL || times[1] != -1500000000LL || times[2] != 0 || times[3] != 1000000001LL ) bad++;
+
+    superSetDiagMode( SG_DIAG_QUIET );
+    if( superParseSpec( spec, 2, bad1, &lastArg ) != SG_ERROR_INCORRECT_ARG || superLastDiag()->expectedType != SG_TYPE_SIZE ) bad++;
+    if( superParseSpec( spec, 2, bad2, &lastArg ) != SG_ERROR_INCORRECT_ARG || superLastDiag()->expectedType != SG_TYPE_DURATION ) bad++;
+    if( superParseSpec( spec, 2, bad3, &lastArg ) != SG_ERROR_INCORRECT_ARG ) bad++;
+    superSetDiagMode( SG_DIAG_STDERR );
+
+    /* the ends of the ranges, and a fraction rounded down rather than up past the top */
+    if( superParseSpec( spec, 4, edge, &lastArg ) != 0 || timeout != -9223372036854775807LL - 1 || cache != 18446744073709551614ULL ) bad++;
+    superFreeOpt( spec );
+
+    printf("sizes and durations: %d failures\n", bad);
+    return( bad );
+}
+
+static int tupleCheck( void )
+{
+    superOptSpec_t *spec = NULL, *mixed = NULL;
+    char *labels[3];
+    double xs[3], ys[3];
+    int numPoints = 3, n = 0, numv = 2, v[2], lastArg, bad = 0;
+    char *args[] = { (char *) "-point", (char *) "a", (char *) "1", (char *) "2", (char *) "b", (char *) "3.5", (char *) "4",
+                     (char *) "-n", (char *) "5", (char *) "-point=c", (char *) "5", (char *) "6" };
+    char *many[] = { (char *) "-point", (char *) "a", (char *) "1", (char *) "2", (char *) "b", (char *) "3", (char *) "4",
+                     (char *) "c", (char *) "5", (char *) "6", (char *) "d", (char *) "7", (char *) "8", (char *) "-n", (char *) "1" };
+    char *cut[] = { (char *) "-point", (char *) "a", (char *) "1", (char *) "-n", (char *) "5" };
+    char *badValue[] = { (char *) "-point", (char *) "a", (char *) "x", (char *) "2" };
+
+    if( superCompileOpt( &spec, "-point *(%s %lf %lf)", labels, xs, ys, &numPoints, "labeled points", "-n %d", &n, "n", NULL ) < 0 ) return(1);
+
+    /* the second occurrence starts the columns over, as any * list does */
+    if( superParseSpec( spec, 9, args, &lastArg ) != 0 || numPoints != 2 || n != 5 ) bad++;
+    if( strcmp( labels[1], "b" ) != 0 || xs[0] != 1 || xs[1] != 3.5 || ys[0] != 2 || ys[1] != 4 ) bad++;
+    if( superParseSpec( spec, 3, args + 9, &lastArg ) != 0 || numPoints != 1 || strcmp( labels[0], "c" ) != 0 || ys[0] != 6 ) bad++;
+
+    /* whole tuples past the end are dropped, and the list still ends at -n */
+    if( superParseSpec( spec, 15, many, &lastArg ) != 0 || numPoints != 3 || xs[2] != 5 || n != 1 || superLastDiag()->dropped != 3 ) bad++;
+
+    superSetDiagMode( SG_DIAG_QUIET );
+    if( superParseSpec( spec, 5, cut, &lastArg ) != SG_ERROR_MISSING_ARG || superLastDiag()->expectedType != SG_TYPE_DOUBLE ) bad++;
+    if( superParseSpec( spec, 3, cut, &lastArg ) != SG_ERROR_MISSING_ARG || numPoints != 0 ) bad++;
+    if( superParseSpec( spec, 4, badValue, &lastArg ) != SG_ERROR_INCORRECT_ARG || lastArg != 3 ) bad++;
+    superSetDiagMode( SG_DIAG_STDERR );
+
+    if( strstr( superUsageText( spec, 80, NULL ), "-point (string double double) [...]" ) == NULL ) bad++;
+    superFreeOpt( spec );
+
+    /* a sink gets the fields in turn */
+    {
+        struct sinkSum t = { 0, 0, 0, 0 };
+        char *sinkArgs[] = { (char *) "-t", (char *) "3", (char *) "abc", (char *) "4", (char *) "de", (char *) "-n", (char *) "1" };
+
+        if( superParseOpt( 7, sinkArgs, &lastArg, "-t >*(%d %s)", sumSink, &t, "t", "-n %d", &n, "n", NULL ) != 0 ||
+            t.sum != 12 || t.values != 4 || t.ends != 1 ) bad++;
+        superSetDiagMode( SG_DIAG_QUIET );
+        if( superParseOpt( 4, sinkArgs, &lastArg, "-t >*(%d %s)", sumSink, &t, "t", NULL ) != SG_ERROR_MISSING_ARG ) bad++;
+        superSetDiagMode( SG_DIAG_STDERR );
+    }
+
+    /* more than one % in a * list needs the ( ), and says so in the diag */
+    superSetDiagMode( SG_DIAG_QUIET );
+    if( superCompileOpt( &mixed, "-v *%d %d", v, &numv, "v", NULL ) != SG_ERROR_MIXED_TYPES_IN_VAR ) bad++;
+    if( superLastDiag()->code != SG_ERROR_MIXED_TYPES_IN_VAR || strcmp( superLastDiag()->token, "-v *%d %d" ) != 0 ) bad++;
+    superSetDiagMode( SG_DIAG_STDERR );
+    superFreeOpt( mixed );
+
+#if defined( __cplusplus ) && __cplusplus >= 201703L
+    {
+        std::vector<const char *> names;
+        std::vector<int> counts;
+        int num = 0;
+        char *cppArgs[] = { (char *) "-c", (char *) "x", (char *) "1", (char *) "y", (char *) "2", (char *) "z" };
+
+        if( sg::compile( &spec, SG_OPT( "-c *(%s %d)", &names, &counts, &num, "counts" ) ) < 0 ) return(1);
+        if( superParseSpec( spec, 5, cppArgs, &lastArg ) != 0 || num != 2 || names.size() != 2 || counts[1] != 2 ) bad++;
+        superSetDiagMode( SG_DIAG_QUIET );
+        names.clear();
+        counts.clear();
+        if( superParseSpec( spec, 6, cppArgs, &lastArg ) != SG_ERROR_MISSING_ARG || names.size() != 2 || counts.size() != 2 ) bad++;
+        superSetDiagMode( SG_DIAG_STDERR );
+        superFreeOpt( spec );
+    }
+#endif
+
+    printf("tuple lists: %d failures\n", bad);
+    return( bad );
+}
+
+static int stringsCheck( void )
+{
+    superOptSpec_t *spec = NULL;
+    superOptCtx_t *ctx = superCtxNew();
+    superOptStats_t st;
+    char name1[] = "alice", tag1[] = "x", tag2[] = "y";
+    char *name = NULL, *first, *tags[4];
+    int numTags = 4, lastArg, bad = 0;
+    char *args[] = { (char *) "-name", name1, (char *) "-tags", tag1, tag2 };
+
+    if( ctx == NULL || superCompileOpt( &spec, "-name %s", &name, "name", "-tags *%s", tags, &numTags, "tags", NULL ) < 0 ) return(1);
+
+    /* owned: the values outlive the buffer they came from */
+    superCtxSetStringMode( ctx, SG_STRINGS_OWNED );
+    if( superCtxParseSpec( ctx, spec, 5, args, &lastArg ) != 0 || name == name1 || numTags != 2 ) bad++;
+    strcpy( name1, "bobby" );
+    tag2[0] = 'z';
+    if( strcmp( name, "alice" ) != 0 || strcmp( tags[1], "y" ) != 0 ) bad++;
+
+    /* the next parse reuses the same memory, without a malloc */
+    first = name;
+    superResetStats();
+    if( superCtxParseSpec( ctx, spec, 5, args, &lastArg ) != 0 || name != first || strcmp( name, "bobby" ) != 0 ) bad++;
+    if( superGetStats( &st ) == 0 && st.allocs != 0 ) bad++;
+
+    /* kept: earlier parses' values stay until the strings are freed */
+    superCtxSetStringMode( ctx, SG_STRINGS_KEEP );
+    first = name;
+    strcpy( name1, "carol" );
+    if( superCtxParseSpec( ctx, spec, 5, args, &lastArg ) != 0 || name == first || strcmp( first, "bobby" ) != 0 || strcmp( name, "carol" ) != 0 ) bad++;
+    superCtxFreeStrings( ctx );
+
+    superCtxFree( ctx );
+    superFreeOpt( spec );
+
+    printf("owned strings: %d failures\n", bad);
+    return( bad );
+}
+
+static int accumCheck( void )
+{
+    static char tokens[1000][8];
+    static char *many[2000];
+    superOptSpec_t *spec = NULL;
+    superOptCtx_t *ctx = superCtxNew();
+    superOptStats_t st;
+    superBatchRec_t rec;
+    char **paths = NULL, **names = NULL, **first;
+    int *vals = NULL, *vs = NULL;
+    int numPaths, numDefs, numVs, n = 0, k, lastArg, bad = 0;
+    char *args[] = { (char *) "-I", (char *) "a", (char *) "-D", (char *) "X", (char *) "1", (char *) "-v", (char *) "1", (char *) "2",
+                     (char *) "-I", (char *) "b", (char *) "-v", (char *) "3", (char *) "-D", (char *) "Y", (char *) "2", (char *) "-I=c" };
+    char *cut[] = { (char *) "-D", (char *) "Z", (char *) "-n", (char *) "1" };
+
+    if( ctx == NULL || superCompileOpt( &spec, "-I +%s", &paths, &numPaths, "include path", "-D +%s %d", &names, &vals, &numDefs, "define",
+                                        "-v +*%d", &vs, &numVs, "values", "-n %d", &n, "n", NULL ) < 0 ) return(1);
+
+    /* every occurrence is kept, in order */
+    if( superCtxParseSpec( ctx, spec, 16, args, &lastArg ) != 0 || numPaths != 3 || numDefs != 2 || numVs != 3 ) bad++;
+    if( bad == 0 && (strcmp( paths[0], "a" ) != 0 || strcmp( paths[2], "c" ) != 0 || strcmp( names[1], "Y" ) != 0 || vals[1] != 2 || vs[2] != 3) ) bad++;
+
+    /* the next parse starts the counts over, in the same arrays */
+    first = paths;
+    superResetStats();
+    if( superCtxParseSpec( ctx, spec, 2, args, &lastArg ) != 0 || numPaths != 1 || numDefs != 0 || paths != first ) bad++;
+    if( superGetStats( &st ) == 0 && st.allocs != 0 ) bad++;
+
+    /* a thousand values: the array doubles, so a handful of reallocs */
+    for( k = 0 ; k < 1000 ; k++ )
+    {
+        sprintf( tokens[k], "p%d", k );
+        many[2 * k] = (char *) "-I";
+        many[2 * k + 1] = tokens[k];
+    }
+    superResetStats();
+    if( superCtxParseSpec( ctx, spec, 2000, many, &lastArg ) != 0 || numPaths != 1000 || strcmp( paths[999], "p999" ) != 0 ) bad++;
+    if( superGetStats( &st ) == 0 && st.allocs > 8 ) bad++;
+
+    superCtxSetDiagMode( ctx, SG_DIAG_QUIET );
+    if( superCtxParseSpec( ctx, spec, 4, cut, &lastArg ) != SG_ERROR_MISSING_ARG || numDefs != 0 ) bad++;
+    if( superCtxParseSpec( ctx, spec, 1, args, &lastArg ) != SG_ERROR_MISSING_ARG ) bad++;
+
+    /* the arrays belong to ctx: another context can't grow them, nor can a batch */
+    superSetDiagMode( SG_DIAG_QUIET );
+    if( superParseSpec( spec, 2, args, &lastArg ) != SG_ERROR_BAD_BINDING ) bad++;
+    superSetDiagMode( SG_DIAG_STDERR );
+    rec.argc = 2;
+    rec.argv = args;
+    rec.outBase = &paths;
+    if( superParseBatch( spec, &paths, sizeof(paths), &rec, 1, 1 ) != SG_ERROR_BAD_BINDING ) bad++;
+
+    if( strstr( superUsageText( spec, 80, NULL ), "-I string [-I ...]" ) == NULL ) bad++;
+
+    superCtxFreeLists( ctx );
+    if( paths != NULL || names != NULL || vals != NULL || vs != NULL ) bad++;
+    if( superParseSpec( spec, 2, args, &lastArg ) != 0 || numPaths != 1 || strcmp( paths[0], "a" ) != 0 ) bad++;
+    superFreeLists();
+    superFreeOpt( spec );
+    superCtxFree( ctx );
+
+#if defined( __cplusplus ) && __cplusplus >= 201703L
+    {
+        double *ws = NULL;
+        int numWs;
+        char *cppArgs[] = { (char *) "-w", (char *) "1.5", (char *) "-w", (char *) "2.5" };
+
+        if( sg::compile( &spec, SG_OPT( "-w +%lf", &ws, &numWs, "weights" ) ) < 0 ) return(1);
+        if( superParseSpec( spec, 4, cppArgs, &lastArg ) != 0 || numWs != 2 || ws[1] != 2.5 ) bad++;
+        superFreeLists();
+        superFreeOpt( spec );
+    }
+#endif
+
+    printf("accumulated options: %d failures\n", bad);
+    return( bad );
+}
+
+int main( int argc, char *argv[] )
+{
+    pthread_t threads[NUM_THREADS];
+    int t, total = 0;
+
+    (void) argc;
+    (void) argv;
+
+    for( t = 0 ; t < NUM_THREADS ; t++ ) pthread_create( &threads[t], NULL, worker, (void *) (size_t) t );
+    for( t = 0 ; t < NUM_THREADS ; t++ ) pthread_join( threads[t], NULL );
+
+    for( t = 0 ; t < NUM_THREADS ; t++ ) total += failures[t];
+
+    printf("%d threads x %d parses: %d failures\n", NUM_THREADS, NUM_ITERS, total);
+    total += batchCheck();
+    total += rspCheck();
+    total += fileCheck();
+    total += tableCheck();
+    total += statsCheck();
+    total += extrasCheck();
+    total += sinkCheck();
+    total += lazyCheck();
+    total += watchCheck();
+    total += nameCheck();
+    total += usageCheck();
+    total += diagCheck();
+    total += envCheck();
+    total += attachedCheck();
+    total += convertCheck();
+    total += unitsCheck();
+    total += tupleCheck();
+    total += stringsCheck();
+    total += accumCheck();
+    return( total != 0 );
+}